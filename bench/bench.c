@@ -0,0 +1,336 @@
+#include "pwman.h"
+
+/*
+ * Microbenchmarks des chemins critiques (make bench).
+ *
+ * Chaque mesure est calibrée pour durer au moins BENCH_MIN_NS, répétée
+ * BENCH_RUNS fois, et la meilleure répétition est gardée: c'est la plus
+ * stable d'une exécution à l'autre. Le temps vient de CLOCK_MONOTONIC, les
+ * cycles de rdtsc (fréquence de référence du TSC, pas la fréquence réelle).
+ *
+ * Sortie: une ligne par mesure, champs séparés par des tabulations:
+ *   name  size  iters  ns_per_op  cycles_per_op  bytes_per_cycle
+ * Les trois dernières colonnes ont 3 décimales; les lignes "#" sont des
+ * commentaires.
+ */
+
+#define BENCH_FORMAT_VERSION 1
+#define BENCH_MIN_NS 20000000ULL     // 20 ms par répétition
+#define BENCH_RUNS 5
+#define BENCH_MAX_BUF (1024 * 1024)
+#define BENCH_CHURN_SLOTS 256
+#define BENCH_SAVED_STDOUT 63        // descripteur de sauvegarde pendant le bench printf
+#define BENCH_VAULT_FILE "/tmp/pwman_bench.db"
+#define BENCH_PASSWORD "bench-password"
+
+// Exécute `iters` opérations de taille `size`
+typedef void (*bench_fn)(size_t size, uint64_t iters);
+
+static uint8_t *buf_a;
+static uint8_t *buf_b;
+
+static uint64_t rdtsc(void) {
+    uint32_t lo, hi;
+    __asm__ volatile ("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// printf ne connaît que %d: les compteurs 64 bits sont formatés ici
+static char *fmt_u64(char *out, uint64_t value) {
+    char tmp[24];
+    int n = 0;
+
+    do {
+        tmp[n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+
+    for (int i = 0; i < n; i++) out[i] = tmp[n - 1 - i];
+    out[n] = '\0';
+    return out;
+}
+
+// Quotient num / den avec 3 décimales
+static char *fmt_ratio(char *out, uint64_t num, uint64_t den) {
+    char frac[8];
+    uint64_t milli = den ? num * 1000 / den : 0;
+
+    fmt_u64(out, milli / 1000);
+    fmt_u64(frac, milli % 1000 + 1000);   // "1xyz": garde les zéros de tête
+    size_t len = strlen(out);
+    out[len] = '.';
+    memcpy(out + len + 1, frac + 1, 4);
+    return out;
+}
+
+typedef struct {
+    uint64_t iters;
+    uint64_t ns;
+    uint64_t cycles;
+} BenchResult;
+
+/**
+ * Mesure fn(size, iters): calibrage du nombre d'itérations, puis meilleure
+ * de BENCH_RUNS répétitions.
+ */
+static void bench_measure(bench_fn fn, size_t size, BenchResult *result) {
+    uint64_t iters = 1;
+
+    // Double le nombre d'itérations jusqu'à BENCH_MIN_NS
+    for (;;) {
+        uint64_t start = now_ns();
+        fn(size, iters);
+        if (now_ns() - start >= BENCH_MIN_NS || iters >= (1ULL << 40)) break;
+        iters *= 2;
+    }
+
+    result->iters = iters;
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        uint64_t start = now_ns();
+        uint64_t c0 = rdtsc();
+        fn(size, iters);
+        uint64_t cycles = rdtsc() - c0;
+        uint64_t ns = now_ns() - start;
+
+        if (run == 0 || ns < result->ns) {
+            result->ns = ns;
+            result->cycles = cycles;
+        }
+    }
+}
+
+// Imprime une ligne de résultat; bytes_per_op vaut 0 si la taille n'est pas un volume de données
+static void bench_report(const char *name, size_t size, uint64_t bytes_per_op, const BenchResult *result) {
+    char s_size[24], s_iters[24], s_ns[32], s_cycles[32], s_bpc[32];
+
+    printf("%s\t%s\t%s\t%s\t%s\t%s\n", name, fmt_u64(s_size, size), fmt_u64(s_iters, result->iters),
+           fmt_ratio(s_ns, result->ns, result->iters), fmt_ratio(s_cycles, result->cycles, result->iters),
+           fmt_ratio(s_bpc, bytes_per_op * result->iters, result->cycles));
+    stdout_flush();
+}
+
+static void bench_run(const char *name, bench_fn fn, size_t size, uint64_t bytes_per_op) {
+    BenchResult result;
+
+    bench_measure(fn, size, &result);
+    bench_report(name, size, bytes_per_op, &result);
+}
+
+// --- Crypto ---
+
+static void op_chacha20_xor(size_t size, uint64_t iters) {
+    static const uint8_t key[MASTER_KEY_LEN], nonce[CHACHA20_NONCE_LEN];
+    struct chacha20_context ctx;
+
+    chacha20_init_context(&ctx, key, nonce, 0);
+    while (iters--) chacha20_xor(&ctx, buf_a, size);
+}
+
+static void op_chacha20_xor_parallel(size_t size, uint64_t iters) {
+    static const uint8_t key[MASTER_KEY_LEN], nonce[CHACHA20_NONCE_LEN];
+    struct chacha20_context ctx;
+
+    chacha20_init_context(&ctx, key, nonce, 0);
+    while (iters--) chacha20_xor_parallel(&ctx, buf_a, size);
+}
+
+static void op_poly1305(size_t size, uint64_t iters) {
+    static const uint8_t key[POLY1305_KEY_LEN] = { 1 };
+    struct poly1305_context mac;
+    uint8_t tag[POLY1305_TAG_LEN];
+
+    while (iters--) {
+        poly1305_init(&mac, key);
+        poly1305_update(&mac, buf_a, size);
+        poly1305_finish(&mac, tag);
+    }
+}
+
+// --- libc ---
+
+static void op_memcpy(size_t size, uint64_t iters) {
+    while (iters--) memcpy(buf_b, buf_a, size);
+}
+
+static void op_memset(size_t size, uint64_t iters) {
+    while (iters--) memset(buf_a, (int)iters, size);
+}
+
+// Chaînes égales: strcmp parcourt toute la longueur
+static void op_strcmp(size_t size, uint64_t iters) {
+    memset(buf_a, 'a', size);
+    memset(buf_b, 'a', size);
+    buf_a[size] = '\0';
+    buf_b[size] = '\0';
+    while (iters--) strcmp((const char *)buf_a, (const char *)buf_b);
+}
+
+// Allocations et libérations entrelacées sur BENCH_CHURN_SLOTS cases, tailles de size/2 à size
+static void op_malloc_churn(size_t size, uint64_t iters) {
+    void *slots[BENCH_CHURN_SLOTS];
+    uint32_t seed = 12345;
+
+    memset(slots, 0, sizeof(slots));
+    while (iters--) {
+        seed = seed * 1103515245 + 12345;
+        int slot = (int)((seed >> 8) % BENCH_CHURN_SLOTS);
+        free(slots[slot]);
+        slots[slot] = malloc(size / 2 + (seed >> 16) % (size / 2 + 1));
+    }
+    for (int i = 0; i < BENCH_CHURN_SLOTS; i++) free(slots[i]);
+}
+
+// Une ligne formatée de `size` octets environ (stdout redirigé vers /dev/null)
+static void op_printf(size_t size, uint64_t iters) {
+    memset(buf_a, 'x', size);
+    buf_a[size > 24 ? size - 24 : 0] = '\0';
+    while (iters--) printf("%s %d %x %s\n", "entry", (int)iters, (unsigned int)iters, (const char *)buf_a);
+    stdout_flush();
+}
+
+// --- Stockage ---
+
+static Vault bench_vault;
+
+static int bench_vault_fill(int count) {
+    static const KdfParams params = { KDF_MIN_M_COST, 1 };
+    char name[MAX_NAME_LEN];
+
+    vault_free(&bench_vault);
+    vault_init(&bench_vault);
+    if (vault_set_password(&bench_vault, BENCH_PASSWORD, &params) != 0) return -1;
+
+    for (int i = 0; i < count; i++) {
+        memcpy(name, "entry-", 6);
+        fmt_u64(name + 6, (uint64_t)i);
+        PwEntry *entry = vault_append(&bench_vault, name);
+        if (entry == NULL) return -1;
+        memcpy(entry->platform, "example.com", 12);
+        memcpy(entry->user, "user@example.com", 17);
+        memcpy(entry->password, "correct horse battery", 22);
+    }
+    return 0;
+}
+
+static void op_save_vault(size_t size, uint64_t iters) {
+    (void)size;
+    while (iters--) save_vault(BENCH_VAULT_FILE, &bench_vault);
+}
+
+static void op_load_vault(size_t size, uint64_t iters) {
+    Vault loaded;
+
+    (void)size;
+    while (iters--) {
+        if (load_vault(BENCH_VAULT_FILE, &loaded, BENCH_PASSWORD) == 0) vault_free(&loaded);
+    }
+}
+
+static void op_vault_roundtrip(size_t size, uint64_t iters) {
+    Vault loaded;
+
+    (void)size;
+    while (iters--) {
+        save_vault(BENCH_VAULT_FILE, &bench_vault);
+        if (load_vault(BENCH_VAULT_FILE, &loaded, BENCH_PASSWORD) == 0) vault_free(&loaded);
+    }
+}
+
+static size_t file_size(const char *path) {
+    int fd = open(path, O_RDONLY, 0);
+    if (fd < 0) return 0;
+    long size = lseek(fd, 0, SEEK_END);
+    close(fd);
+    return size > 0 ? (size_t)size : 0;
+}
+
+static void bench_storage(void) {
+    static const int counts[] = { 100, 1000, 10000 };
+
+    for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        if (bench_vault_fill(counts[i]) != 0 || save_vault(BENCH_VAULT_FILE, &bench_vault) != 0) {
+            puts("# storage: setup failed\n");
+            break;
+        }
+        size_t bytes = file_size(BENCH_VAULT_FILE);
+        bench_run("save_vault", op_save_vault, (size_t)counts[i], bytes);
+        bench_run("load_vault", op_load_vault, (size_t)counts[i], bytes);
+        bench_run("vault_roundtrip", op_vault_roundtrip, (size_t)counts[i], 2 * bytes);
+    }
+
+    // load_vault met la clé en cache: on ne laisse rien dans le trousseau
+    vault_forget_key(BENCH_VAULT_FILE);
+    unlink(BENCH_VAULT_FILE);
+    vault_free(&bench_vault);
+}
+
+// Le bench printf écrit dans /dev/null; les résultats restent sur la vraie sortie
+static void bench_printf(void) {
+    static const size_t sizes[] = { 32, 128, 1024 };
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        BenchResult result;
+        int null_fd = open("/dev/null", O_WRONLY, 0);
+        if (null_fd < 0 || dup2(1, BENCH_SAVED_STDOUT) < 0) {
+            puts("# printf: cannot redirect stdout\n");
+            return;
+        }
+        dup2(null_fd, 1);
+        bench_measure(op_printf, sizes[i], &result);
+        dup2(BENCH_SAVED_STDOUT, 1);
+        close(BENCH_SAVED_STDOUT);
+        close(null_fd);
+
+        bench_report("printf", sizes[i], sizes[i], &result);
+    }
+}
+
+int main(void) {
+    static const size_t crypto_sizes[] = { 64, 256, 1024, 16384, BENCH_MAX_BUF };
+    static const size_t mem_sizes[] = { 16, 64, 256, 4096, 65536 };
+    static const size_t alloc_sizes[] = { 32, 256, 4096, 262144 };
+
+    buf_a = malloc(BENCH_MAX_BUF + 1);
+    buf_b = malloc(BENCH_MAX_BUF + 1);
+    if (buf_a == NULL || buf_b == NULL) {
+        puts("Error: Not enough memory.\n");
+        return 1;
+    }
+    memset(buf_a, 0x5a, BENCH_MAX_BUF + 1);
+    memset(buf_b, 0xa5, BENCH_MAX_BUF + 1);
+
+    printf("# pwman-bench %d\n", BENCH_FORMAT_VERSION);
+    printf("# name\tsize\titers\tns_per_op\tcycles_per_op\tbytes_per_cycle\n");
+
+    for (size_t i = 0; i < sizeof(crypto_sizes) / sizeof(crypto_sizes[0]); i++) {
+        bench_run("chacha20_xor", op_chacha20_xor, crypto_sizes[i], crypto_sizes[i]);
+    }
+    bench_run("chacha20_xor_parallel", op_chacha20_xor_parallel, BENCH_MAX_BUF, BENCH_MAX_BUF);
+    for (size_t i = 0; i < sizeof(crypto_sizes) / sizeof(crypto_sizes[0]); i++) {
+        bench_run("poly1305", op_poly1305, crypto_sizes[i], crypto_sizes[i]);
+    }
+    for (size_t i = 0; i < sizeof(mem_sizes) / sizeof(mem_sizes[0]); i++) {
+        bench_run("memcpy", op_memcpy, mem_sizes[i], mem_sizes[i]);
+    }
+    for (size_t i = 0; i < sizeof(mem_sizes) / sizeof(mem_sizes[0]); i++) {
+        bench_run("memset", op_memset, mem_sizes[i], mem_sizes[i]);
+    }
+    for (size_t i = 0; i < sizeof(mem_sizes) / sizeof(mem_sizes[0]); i++) {
+        bench_run("strcmp", op_strcmp, mem_sizes[i], mem_sizes[i]);
+    }
+    for (size_t i = 0; i < sizeof(alloc_sizes) / sizeof(alloc_sizes[0]); i++) {
+        bench_run("malloc_churn", op_malloc_churn, alloc_sizes[i], 0);
+    }
+    bench_printf();
+    bench_storage();
+
+    free(buf_a);
+    free(buf_b);
+    return 0;
+}
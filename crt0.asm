@@ -11,7 +11,7 @@ _start:
     extern main
     call    main
  
-    ; system call exit(ret)
+    ; exit(ret) flushes buffered stdout, then does the exit syscall
+    extern exit
     mov     rdi, rax            ; main returned value
-    mov     rax, 60             ; syscall exit
-    syscall
\ No newline at end of file
+    call    exit
\ No newline at end of file
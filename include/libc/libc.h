@@ -1,14 +1,17 @@
 /*
- * libc.h - Header pour l'allocateur mémoire simple
+ * libc.h - Header de la mini libc
  * 
- * Structure de bloc mémoire:
- * [block_header_t][données utilisateur]
+ * Structure de bloc mémoire (étiquettes de frontière):
+ * [block_header_t][données utilisateur ...][pied: taille, si libre]
  * 
- * Le header contient la taille + bit d'état (bit 0):
- * - 0 = bloc libre
- * - 1 = bloc occupé
+ * Le header contient la taille totale du bloc (multiple de 16) + bits d'état:
+ * - bit 0: bloc occupé (0 = libre)
+ * - bit 1: bloc précédent occupé
+ * - bit 2: bloc projeté par mmap() (grandes tailles, hors du heap)
  * 
- * Free list: les blocs libres sont chaînés via leurs données
+ * Un bloc libre recopie sa taille dans ses 8 derniers octets, ce qui permet
+ * de retrouver le bloc précédent pour la fusion. Les blocs libres sont
+ * chaînés dans des listes par classe de taille (voir malloc.c).
  */
 
 #ifndef LIBC_H
@@ -28,38 +31,152 @@ typedef long long ssize_t;
 #define O_CREAT     64
 #define O_TRUNC     512
 
+// Origines pour lseek()
+#define SEEK_SET    0
+#define SEEK_CUR    1
+#define SEEK_END    2
+
+// Projections mémoire pour mmap() / msync()
+#define PROT_READ       1
+#define PROT_WRITE      2
+#define MAP_SHARED      0x01
+#define MAP_PRIVATE     0x02
+#define MAP_ANONYMOUS   0x20
+#define MAP_POPULATE    0x8000
+#define MAP_FAILED      ((void *)-1)
+#define MREMAP_MAYMOVE  1
+#define MS_ASYNC        1
+#define MS_SYNC         4
+
+// Requête ioctl() des terminaux
+#define TCGETS          0x5401
+
+// Sockets locales (AF_UNIX) et epoll
+#define AF_UNIX         1
+#define SOCK_STREAM     1
+#define SOCK_NONBLOCK   04000
+#define SOCK_CLOEXEC    02000000
+#define MSG_NOSIGNAL    0x4000
+#define EPOLLIN         0x001
+#define EPOLLOUT        0x004
+#define EPOLLERR        0x008
+#define EPOLLHUP        0x010
+#define EPOLL_CTL_ADD   1
+#define EPOLL_CTL_DEL   2
+#define EPOLL_CTL_MOD   3
+
+// Threads: clone() et futex()
+#define CLONE_VM              0x00000100
+#define CLONE_FS              0x00000200
+#define CLONE_FILES           0x00000400
+#define CLONE_SIGHAND         0x00000800
+#define CLONE_THREAD          0x00010000
+#define CLONE_SYSVSEM         0x00040000
+#define CLONE_PARENT_SETTID   0x00100000
+#define CLONE_CHILD_CLEARTID  0x00200000
+#define FUTEX_WAIT            0
+#define FUTEX_WAKE            1
+
+// Trousseaux de clés du noyau
+#define KEY_SPEC_SESSION_KEYRING  -3
+#define KEYCTL_GET_KEYRING_ID     0
+#define KEYCTL_READ               11
+#define KEYCTL_SET_TIMEOUT        15
+#define KEYCTL_INVALIDATE         21
+
+// Codes d'erreur (les appels système retournent -errno)
+#define EINTR           4
+#define EAGAIN          11
+
+struct sockaddr_un {
+    unsigned short sun_family;
+    char sun_path[108];
+};
+
+struct epoll_event {
+    unsigned int events;
+    unsigned long long data;
+} __attribute__((packed));
+
+// Horloges pour clock_gettime()
+#define CLOCK_REALTIME  0
+#define CLOCK_MONOTONIC 1
+
+struct timespec {
+    long tv_sec;
+    long tv_nsec;
+};
+
 // Structure d'un header de bloc
 typedef struct {
-    size_t size; // Taille + bit d'état (bit 0: 0=libre, 1=occupé)
+    size_t size; // Taille + bits d'état (BLOCK_USED, BLOCK_PREV_USED)
 } block_header_t;
 
 // Macros de base
 #define ALIGN(size) (((size) + 15) & ~15)
-#define GET_SIZE(h) ((h)->size & ~1)
-#define IS_FREE(h) (((h)->size & 1) == 0)
-#define SET_FREE(h) ((h)->size = GET_SIZE(h))
-#define SET_USED(h) ((h)->size = GET_SIZE(h) | 1)
+#define BLOCK_USED       1
+#define BLOCK_PREV_USED  2
+#define BLOCK_MMAPPED    4
+#define BLOCK_FLAGS      15
+#define MIN_BLOCK_SIZE   32
+#define MMAP_THRESHOLD   (128 * 1024) // au-delà, malloc() projette le bloc à part
+#define BLOCK_SIZE_FOR(n) ((ALIGN((n) + sizeof(block_header_t)) < MIN_BLOCK_SIZE) \
+                           ? MIN_BLOCK_SIZE : ALIGN((n) + sizeof(block_header_t)))
+#define GET_SIZE(h) ((h)->size & ~(size_t)BLOCK_FLAGS)
+#define IS_FREE(h) (((h)->size & BLOCK_USED) == 0)
+#define IS_PREV_FREE(h) (((h)->size & BLOCK_PREV_USED) == 0)
+#define SET_FREE(h) ((h)->size &= ~(size_t)BLOCK_USED)
+#define SET_USED(h) ((h)->size |= BLOCK_USED)
+#define NEXT_BLOCK(h) ((block_header_t *)((char *)(h) + GET_SIZE(h)))
+#define BLOCK_DATA(h) ((void *)((char *)(h) + sizeof(block_header_t)))
+#define DATA_BLOCK(p) ((block_header_t *)((char *)(p) - sizeof(block_header_t)))
+#define IS_MMAPPED(h) (((h)->size & BLOCK_MMAPPED) != 0)
+
+// Internes de l'allocateur (malloc.c), partagés avec free() et realloc()
+void heap_bin_remove(block_header_t *block);
+void heap_split(block_header_t *block, size_t size);
+void heap_release(block_header_t *block);
+int heap_extend(block_header_t *block, size_t size);
+void heap_trim(void);
+void *heap_mmap_alloc(size_t size);
+void *heap_mmap_resize(block_header_t *block, size_t size);
+void heap_mmap_free(block_header_t *block);
 
 // Fonctions d'I/O
 ssize_t write(int fd, const void *buf, size_t count);
 ssize_t read(int fd, void *buf, size_t count);
 int putchar(char c);
+ssize_t stdout_write(const void *buf, size_t count);
+int stdout_flush(void);
 int puts(const char *str);
 ssize_t getline(char **lineptr, size_t *n, int fd);
 ssize_t readline(char *buf, size_t size);
+ssize_t read_buffered(int fd, const char **data);
+void read_consume(int fd, size_t n);
+void read_discard(int fd);
 int close(int fd);
 int open(const char *pathname, int flags, int mode);
+ssize_t pread(int fd, void *buf, size_t count, long offset);
+ssize_t pwrite(int fd, const void *buf, size_t count, long offset);
+long lseek(int fd, long offset, int whence);
+int ftruncate(int fd, long length);
+int ioctl(int fd, unsigned long request, void *arg);
+int isatty(int fd);
 
 // Fonctions de string
 int strcmp(const char *s1, const char *s2);
 int strncmp(const char *s1, const char *s2, size_t n);
 size_t strlen(const char *s);
 void *memcpy(void *dest, const void *src, size_t n);
+int memcmp(const void *s1, const void *s2, size_t n);
+void *memchr(const void *s, int c, size_t n);
+void *memmem(const void *haystack, size_t hlen, const void *needle, size_t nlen);
 
 // Fonctions utilitaires
 int putnbr(int num);
 int printf(const char *format, ...);
 void exit(int status) __attribute__((noreturn));
+int clock_gettime(int clock_id, struct timespec *ts);
 
 // Fonctions de gestion de la mémoire
 void *brk(void *addr);
@@ -68,6 +185,22 @@ void *malloc(size_t size);
 void free(void *ptr);
 void *realloc(void *ptr, size_t size);
 void *memset(void *s, int c, size_t n);
+void *mmap(void *addr, size_t length, int prot, int flags, int fd, long offset);
+int munmap(void *addr, size_t length);
+void *mremap(void *old_addr, size_t old_size, size_t new_size, int flags);
+int msync(void *addr, size_t length, int flags);
+
+// Arènes: allocation par pointeur croissant, libérée et effacée en bloc
+typedef struct arena arena_t;
+arena_t *arena_create(size_t chunk_size);
+void *arena_alloc(arena_t *arena, size_t size);
+void arena_reset(arena_t *arena);
+void arena_destroy(arena_t *arena);
+
+// Détection du processeur (cpuid), pour choisir les chemins vectorisés
+#define CPU_FEATURE_SSE2    (1 << 0)
+#define CPU_FEATURE_AVX2    (1 << 1)
+unsigned int cpu_features(void);
 
 // Fonctions de processus
 int execve(const char *pathname, char *const argv[], char *const envp[]);
@@ -76,4 +209,91 @@ int waitpid(int pid, int *status, int options);
 int getpid(void);
 int pipe(int pipefd[2]);
 int dup2(int oldfd, int newfd);
+int setsid(void);
+int umask(int mask);
+int unlink(const char *pathname);
+
+// Sockets et multiplexage
+int socket(int domain, int type, int protocol);
+int bind(int sockfd, const void *addr, unsigned int addrlen);
+int listen(int sockfd, int backlog);
+int accept4(int sockfd, void *addr, unsigned int *addrlen, int flags);
+int connect(int sockfd, const void *addr, unsigned int addrlen);
+ssize_t send(int sockfd, const void *buf, size_t len, int flags);
+int epoll_create1(int flags);
+int epoll_ctl(int epfd, int op, int fd, struct epoll_event *event);
+int epoll_wait(int epfd, struct epoll_event *events, int maxevents, int timeout);
+
+/*
+ * Statistiques d'exécution (stats.c), compilées seulement avec -DPWMAN_STATS
+ * (make STATS=1): appels, échecs et octets des wrappers de syscalls, durée
+ * cumulée de phases nommées. Sans PWMAN_STATS, les macros ne génèrent rien.
+ */
+#ifdef PWMAN_STATS
+enum {
+    STAT_SYS_READ, STAT_SYS_PREAD, STAT_SYS_WRITE, STAT_SYS_PWRITE, STAT_SYS_SEND,
+    STAT_SYS_OPEN, STAT_SYS_CLOSE, STAT_SYS_LSEEK, STAT_SYS_FTRUNCATE, STAT_SYS_UNLINK,
+    STAT_SYS_BRK, STAT_SYS_MMAP, STAT_SYS_MUNMAP, STAT_SYS_MREMAP, STAT_SYS_MSYNC,
+    STAT_SYS_FORK, STAT_SYS_EXECVE, STAT_SYS_WAITPID, STAT_SYS_GETPID, STAT_SYS_PIPE,
+    STAT_SYS_DUP2, STAT_SYS_SETSID, STAT_SYS_UMASK,
+    STAT_SYS_SOCKET, STAT_SYS_BIND, STAT_SYS_LISTEN, STAT_SYS_ACCEPT4, STAT_SYS_CONNECT,
+    STAT_SYS_EPOLL_CREATE1, STAT_SYS_EPOLL_CTL, STAT_SYS_EPOLL_WAIT,
+    STAT_SYS_ADD_KEY, STAT_SYS_REQUEST_KEY, STAT_SYS_KEYCTL,
+    STAT_SYS_CLONE, STAT_SYS_FUTEX, STAT_SYS_SCHED_GETAFFINITY,
+    STAT_SYS_IOCTL,
+    STAT_SYS_COUNT
+};
+
+void stats_enable(void);
+void stats_syscall(int sys, long ret);
+unsigned long long stats_now(void);
+void stats_phase(const char *name, unsigned long long start);
+void stats_report(void);
+
+#define STATS_SYSCALL(sys, ret) stats_syscall(sys, (long)(ret))
+#define STATS_BEGIN(t) unsigned long long t = stats_now()
+#define STATS_END(t, name) stats_phase(name, t)
+#else
+#define STATS_SYSCALL(sys, ret) ((void)0)
+#define STATS_BEGIN(t) ((void)0)
+#define STATS_END(t, name) ((void)0)
+#endif
+
+// Threads (thread.c): pile propre, fin attendue par futex sur le TID
+typedef struct {
+    int tid;            // remis à 0 par le noyau à la fin du thread
+    void *stack;
+    size_t stack_size;
+} thread_t;
+
+int clone(int (*fn)(void *), void *arg, void *stack, unsigned long flags, int *parent_tid, int *child_tid);
+long futex(int *uaddr, int op, int val, const struct timespec *timeout);
+int sched_getaffinity(int pid, size_t size, void *mask);
+void futex_wait(int *addr, int expected);
+void futex_wake(int *addr, int count);
+int thread_create(thread_t *thread, int (*fn)(void *), void *arg);
+void thread_join(thread_t *thread);
+int cpu_count(void);
+
+// Pool à vol de tâches (pool.c), partagé par tout le processus
+typedef struct {
+    int pending;        // tâches non terminées, et thread qui attend (pool.c)
+} pool_group_t;
+
+typedef struct {
+    void (*fn)(void *arg);
+    void *arg;
+    pool_group_t *group;
+} pool_task_t;
+
+int pool_size(void);
+void pool_submit(pool_group_t *group, pool_task_t *task, void (*fn)(void *), void *arg);
+void pool_wait(pool_group_t *group);
+void pool_parallel_for(size_t begin, size_t end, size_t grain, void (*fn)(void *arg, size_t begin, size_t end), void *arg);
+void pool_after_fork(void);
+
+// Trousseaux de clés
+int add_key(const char *type, const char *description, const void *payload, size_t plen, int keyring);
+int request_key(const char *type, const char *description, const char *callout_info, int dest_keyring);
+long keyctl(int operation, unsigned long arg2, unsigned long arg3, unsigned long arg4, unsigned long arg5);
 #endif
@@ -0,0 +1,37 @@
+/*
+ * simd.h - Outils vectoriels des fonctions de chaîne (SSE2 / AVX2)
+ * 
+ * Extensions vectorielles de GCC plus pmovmskb: une comparaison octet par
+ * octet donne un masque de 16 (ou 32) bits, un bit par octet.
+ * 
+ * Lectures sûres en fin de page: une lecture alignée sur sa taille ne
+ * traverse jamais une frontière de page, elle ne peut donc pas fauter même
+ * si elle déborde après la fin de la chaîne. Une lecture non alignée n'est
+ * faite que si PAGE_CROSSES() est faux.
+ */
+
+#ifndef LIBC_SIMD_H
+#define LIBC_SIMD_H
+
+typedef char v16qi __attribute__((vector_size(16), may_alias));
+typedef char v16qi_u __attribute__((vector_size(16), aligned(1), may_alias));
+typedef char v32qi __attribute__((vector_size(32), may_alias));
+typedef char v32qi_u __attribute__((vector_size(32), aligned(1), may_alias));
+
+#define SPLAT16(c) ((v16qi){ c, c, c, c, c, c, c, c, c, c, c, c, c, c, c, c })
+#define SPLAT32(c) ((v32qi){ c, c, c, c, c, c, c, c, c, c, c, c, c, c, c, c, \
+                             c, c, c, c, c, c, c, c, c, c, c, c, c, c, c, c })
+
+// Masque des octets non nuls d'un résultat de comparaison
+#define MOVEMASK16(v) ((unsigned int)__builtin_ia32_pmovmskb128((v16qi)(v)))
+#define MOVEMASK32(v) ((unsigned int)__builtin_ia32_pmovmskb256((v32qi)(v)))
+
+#define PAGE_SIZE 4096
+#define PAGE_CROSSES(p, n) ((((unsigned long)(p)) & (PAGE_SIZE - 1)) > PAGE_SIZE - (n))
+
+// Mots de 64 bits: un octet nul dans v (astuce "haszero")
+#define ONES64  0x0101010101010101ULL
+#define HIGHS64 0x8080808080808080ULL
+#define HAS_ZERO64(v) (((v) - ONES64) & ~(v) & HIGHS64)
+
+#endif
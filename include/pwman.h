@@ -7,13 +7,28 @@ typedef unsigned char  uint8_t;
 typedef unsigned int   uint32_t;
 typedef unsigned long long uint64_t;
 
-#define MAX_ENTRIES 100
+#define VAULT_MAGIC "PWMV"
+#define VAULT_VERSION 8
+#define VAULT_INITIAL_CAPACITY 16
+#define VAULT_MAX_ENTRIES (1 << 22)
 #define MAX_NAME_LEN 64
 #define MAX_PLATFORM_LEN 64
 #define MAX_USER_LEN 64
 #define MAX_PASSWORD_LEN 64
 #define MASTER_KEY_LEN 32      
 #define CHACHA20_NONCE_LEN 12  
+#define INDEX_KEY_LEN 16
+#define VAULT_INDEX_MIN_CAPACITY 16
+#define KDF_SALT_LEN 16
+#define KDF_DEFAULT_M_COST (16 * 1024)  // Kio
+#define KDF_DEFAULT_T_COST 1
+#define KDF_MIN_M_COST 8
+#define KDF_MAX_M_COST (4 * 1024 * 1024)
+#define KDF_MAX_T_COST 64
+#define KEY_CACHE_TIMEOUT 300       // secondes de vie de la clé dans le trousseau
+#define POLY1305_KEY_LEN 32
+#define POLY1305_TAG_LEN 16
+#define KEY_CHECK_LEN 16
 
 typedef struct {
     char name[MAX_NAME_LEN];
@@ -22,15 +37,152 @@ typedef struct {
     char password[MAX_PASSWORD_LEN];
 } PwEntry;
 
+/*
+ * Case de l'index de noms (adressage ouvert, sondage linéaire).
+ * La position vient des bits bas du SipHash du nom, tag garde les bits hauts
+ * pour éviter de relire l'enregistrement sur une collision de case.
+ */
+typedef struct {
+    uint32_t tag;
+    uint32_t record;    // index de l'entrée + 1, 0 = case vide
+} VaultIndexSlot;
+
+// Paramètres de coût de la KDF, stockés en clair dans l'en-tête du coffre
+typedef struct {
+    uint32_t m_cost;    // mémoire, en blocs de 1 Kio
+    uint32_t t_cost;    // passes sur la mémoire
+} KdfParams;
+
+/*
+ * Coffre en mémoire: les entrées sont allouées sur le heap et grandissent à la demande.
+ * La clé maître dérivée (et le sel, les paramètres qui la produisent) est
+ * gardée pour que save_vault n'ait pas à repasser par la KDF.
+ */
 typedef struct {
     int count;
-    PwEntry entries[MAX_ENTRIES];
+    int capacity;
+    PwEntry *entries;
+    VaultIndexSlot *index;
+    int index_capacity;     // puissance de 2, au moins 2 * count
+    uint8_t index_key[INDEX_KEY_LEN];
+    uint8_t key[MASTER_KEY_LEN];
+    uint8_t salt[KDF_SALT_LEN];
+    KdfParams kdf;
 } Vault;
 
+#define VAULT_ENTRIES_OFFSET 64   // position du snapshot dans le keystream (bloc 1)
+
+/*
+ * En-tête du fichier de coffre. Il est suivi du snapshot, chiffré d'un seul
+ * tenant à partir de l'offset VAULT_ENTRIES_OFFSET du keystream:
+ * - la table des enregistrements: `count` offsets (uint32_t) dans le pool;
+ * - les `index_capacity` cases de l'index de noms;
+ * - le pool de `pool_len` octets: name, platform, user et password de chaque
+ *   entrée, chacun précédé de sa longueur en varint (LEB128), sans '\0'.
+ *   Avec VAULT_FLAG_LZ, le pool est stocké compressé par blocs indépendants
+ *   de LZ_BLOCK_SIZE octets (lz.c): la table des (blocs + 1) débuts de bloc
+ *   (uint32_t), puis les blocs. `pool_size` est la taille stockée.
+ * puis du journal: des JournalRecord ajoutés en fin de fichier par add.
+ * count, index_capacity, pool_len et pool_size sont chiffrés avec le bloc 0
+ * du keystream.
+ * Le sel et les paramètres de la KDF sont en clair: ils sont nécessaires
+ * pour dériver la clé. key_check (sous-clé "pwman-check") permet de rejeter
+ * un mauvais mot de passe sans rien déchiffrer; tag est le Poly1305 de
+ * l'en-tête (hors tag) et du snapshot chiffré.
+ */
+typedef struct {
+    uint8_t magic[4];
+    uint32_t version;
+    uint32_t flags;
+    uint8_t salt[KDF_SALT_LEN];
+    KdfParams kdf;
+    uint8_t nonce[CHACHA20_NONCE_LEN];
+    uint8_t key_check[KEY_CHECK_LEN];
+    uint8_t tag[POLY1305_TAG_LEN];
+    uint32_t count;
+    uint32_t index_capacity;
+    uint32_t pool_len;
+    uint32_t pool_size;
+} VaultFileHeader;
+
+#define VAULT_FLAG_LZ 1            // pool compressé (compression avant chiffrement)
+#define LZ_BLOCK_SIZE (32 * 1024)  // taille décompressée d'un bloc du pool
+
+/*
+ * Enregistrement du journal: une entrée chiffrée avec la clé maître et son
+ * propre nonce (compteur 0), et le Poly1305 de l'entrée chiffrée. Au
+ * chargement, le journal est rejoué sur le snapshot; `compact` le réintègre
+ * dans un nouveau snapshot.
+ */
 typedef struct {
     uint8_t nonce[CHACHA20_NONCE_LEN];
-    uint8_t encrypted_vault[sizeof(Vault)];
-} VaultFileLayout;
+    uint8_t tag[POLY1305_TAG_LEN];
+    PwEntry entry;
+} JournalRecord;
+
+// Accès direct aux enregistrements d'un fichier de coffre ouvert
+typedef struct {
+    int fd;
+    int count;
+    int index_capacity;
+    int journal_count;
+    uint32_t flags;
+    uint32_t pool_len;
+    uint32_t pool_size;
+    uint8_t key[MASTER_KEY_LEN];
+    uint8_t mac_key[MASTER_KEY_LEN];
+    uint8_t nonce[CHACHA20_NONCE_LEN];
+    uint8_t index_key[INDEX_KEY_LEN];
+    uint8_t salt[KDF_SALT_LEN];
+    KdfParams kdf;
+} VaultHandle;
+
+/*
+ * Protocole de l'agent (socket AF_UNIX "<db_file>.sock"): le client envoie
+ * une AgentRequest de taille fixe, l'agent répond par une AgentReply suivie
+ * de `count` PwEntry (get: 1, list: toutes, sans les mots de passe).
+ */
+#define AGENT_SOCKET_SUFFIX ".sock"
+#define AGENT_DEFAULT_IDLE 900    // secondes sans requête avant verrouillage
+#define AGENT_MAX_IDLE 86400
+
+enum { AGENT_OP_GET = 1, AGENT_OP_LIST, AGENT_OP_ADD, AGENT_OP_LOCK };
+enum { AGENT_OK = 0, AGENT_NOT_FOUND, AGENT_EXISTS, AGENT_FAILED };
+
+typedef struct {
+    uint32_t op;
+    PwEntry entry;      // get: name; add: entrée complète
+} AgentRequest;
+
+typedef struct {
+    uint32_t status;
+    uint32_t count;
+} AgentReply;
+
+/*
+ * Index de trigrammes de la commande search (search.c): name, platform et
+ * user de chaque entrée sont recopiés en minuscules dans `text` (un '\n'
+ * après chaque champ), et chaque trigramme, haché sur TRIGRAM_BITS bits,
+ * a sa liste croissante des champs qui le contiennent dans `postings`
+ * (entrée * TRIGRAM_FIELDS + champ: name 0, platform 1, user 2).
+ */
+#define TRIGRAM_BITS 14
+#define TRIGRAM_BUCKETS (1 << TRIGRAM_BITS)
+#define TRIGRAM_FIELDS 3
+#define SEARCH_MAX_RESULTS 20
+
+typedef struct {
+    int count;
+    char *text;
+    uint32_t *text_offset;    // count + 1 positions dans text
+    uint32_t *bucket_start;   // TRIGRAM_BUCKETS + 1 positions dans postings
+    uint32_t *postings;
+} TrigramIndex;
+
+typedef struct {
+    int record;
+    int score;
+} SearchHit;
 
 struct chacha20_context
 {
@@ -39,11 +191,62 @@ struct chacha20_context
     uint32_t state[16];
 };
 
-void normalize_key(const char *password, uint8_t *key_buffer);
+struct poly1305_context
+{
+    uint32_t h[5];
+    uint32_t r_pow[4][5];   // r, r^2, r^3, r^4 en limbs de 26 bits
+    uint32_t pad[4];
+    uint8_t buffer[16];
+    size_t leftover;
+};
+
+int kdf_derive(const char *password, const uint8_t salt[KDF_SALT_LEN], const KdfParams *params, uint8_t key[MASTER_KEY_LEN]);
 void chacha20_init_context(struct chacha20_context *ctx, const uint8_t key[], const uint8_t nonce[], uint64_t counter);
+void chacha20_seek(struct chacha20_context *ctx, uint64_t offset);
 void chacha20_xor(struct chacha20_context *ctx, uint8_t *bytes, size_t n_bytes);
+void chacha20_xor_parallel(struct chacha20_context *ctx, uint8_t *bytes, size_t n_bytes);
+void derive_subkey(const uint8_t key[], const char *label, uint8_t *out, size_t len);
+uint64_t siphash24(const uint8_t key[INDEX_KEY_LEN], const void *data, size_t len);
+void poly1305_init(struct poly1305_context *ctx, const uint8_t key[POLY1305_KEY_LEN]);
+void poly1305_update(struct poly1305_context *ctx, const uint8_t *m, size_t len);
+void poly1305_finish(struct poly1305_context *ctx, uint8_t tag[POLY1305_TAG_LEN]);
+int poly1305_verify(const uint8_t a[POLY1305_TAG_LEN], const uint8_t b[POLY1305_TAG_LEN]);
+size_t lz_compress(const uint8_t *src, size_t len, uint8_t *dst, size_t cap);
+int lz_decompress(const uint8_t *src, size_t len, uint8_t *dst, size_t out_len);
+void chacha20_xor_blocks_sse2(uint32_t state[16], uint8_t *bytes, size_t n_blocks);
+void chacha20_xor_blocks_avx2(uint32_t state[16], uint8_t *bytes, size_t n_blocks);
+void poly1305_blocks_avx2(uint32_t h[5], const uint32_t r_pow[4][5], const uint8_t *m, size_t n_blocks);
+
+void vault_init(Vault *vault);
+int vault_set_password(Vault *vault, const char *password, const KdfParams *params);
+int vault_reserve(Vault *vault, int capacity);
+PwEntry *vault_append(Vault *vault, const char *name);
+int vault_lookup(const Vault *vault, const char *name);
+void vault_free(Vault *vault);
+
+int vault_open(const char *filepath, VaultHandle *handle, const char *master_password);
+int vault_load_entries(VaultHandle *handle, Vault *vault);
+int vault_read_entries(VaultHandle *handle, int first, int n, PwEntry *out);
+int vault_find_entry(VaultHandle *handle, const char *name, PwEntry *out);
+int vault_read_journal(VaultHandle *handle, int first, int n, PwEntry *out);
+int vault_journal_append(const char *filepath, VaultHandle *handle, const PwEntry *entry);
+void vault_close(VaultHandle *handle);
+
+int save_vault(const char *filepath, Vault *vault);
+
+int vault_key_cached(const char *filepath);
+int vault_forget_key(const char *filepath);
+
+int keycache_lookup(const uint8_t salt[KDF_SALT_LEN], uint8_t key[MASTER_KEY_LEN]);
+void keycache_store(const uint8_t salt[KDF_SALT_LEN], const uint8_t key[MASTER_KEY_LEN]);
+int keycache_forget(const uint8_t salt[KDF_SALT_LEN]);
+
+int trigram_index_build(TrigramIndex *index, const PwEntry *entries, int count, arena_t *arena);
+int trigram_search(const TrigramIndex *index, const char *query, SearchHit *hits, int max_hits, arena_t *arena);
 
-int save_vault(const char *filepath, Vault *vault, const char *master_password);
+int agent_run(const char *db_file, const char *master_password, int idle_seconds);
+int agent_connect(const char *db_file);
+int agent_call(int fd, uint32_t op, const PwEntry *entry, AgentReply *reply, PwEntry **entries);
 int load_vault(const char *filepath, Vault *vault, const char *master_password);
 
 #endif 
\ No newline at end of file
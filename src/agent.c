@@ -0,0 +1,428 @@
+#include "pwman.h"
+
+/*
+ * Agent: garde le coffre déverrouillé en mémoire (entrées et index sur le
+ * heap) et répond aux commandes get/list/add des clients locaux sur une
+ * socket AF_UNIX, sans KDF ni déchiffrement par requête.
+ *
+ * Une seule boucle epoll non bloquante sert la socket d'écoute et les
+ * clients; chaque client lit une AgentRequest complète, puis passe en
+ * écriture jusqu'à ce que sa réponse soit envoyée. Sans requête pendant
+ * idle_seconds, l'agent efface le coffre et s'arrête.
+ *
+ * Les ajouts sont écrits dans le journal du fichier (vault_journal_append),
+ * comme le fait add, puis appliqués au coffre en mémoire.
+ * La socket est créée en 0600 (umask 077).
+ */
+
+#define AGENT_MAX_CLIENTS 64
+#define AGENT_MAX_EVENTS 16
+#define AGENT_LISTEN_ID ((unsigned long long)-1)
+
+typedef struct {
+    int fd;                 // -1: case libre
+    size_t in_len;
+    AgentRequest request;
+    uint8_t *out;
+    size_t out_len;
+    size_t out_pos;
+    unsigned int events;    // événements epoll surveillés
+} AgentClient;
+
+typedef struct {
+    const char *db_file;
+    Vault vault;
+    VaultHandle handle;
+    int epoll_fd;
+    int listen_fd;
+    int running;
+    AgentClient clients[AGENT_MAX_CLIENTS];
+} Agent;
+
+static int agent_socket_path(const char *db_file, struct sockaddr_un *addr) {
+    size_t len = strlen(db_file);
+    size_t suffix_len = strlen(AGENT_SOCKET_SUFFIX);
+
+    if (len + suffix_len >= sizeof(addr->sun_path)) return -1;
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    memcpy(addr->sun_path, db_file, len);
+    memcpy(addr->sun_path + len, AGENT_SOCKET_SUFFIX, suffix_len);
+    return 0;
+}
+
+/**
+ * Se connecte à l'agent du coffre `db_file`. Retourne la socket, ou -1 si
+ * aucun agent n'écoute.
+ */
+int agent_connect(const char *db_file) {
+    struct sockaddr_un addr;
+
+    if (agent_socket_path(db_file, &addr) != 0) return -1;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, &addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int send_full(int fd, const void *buf, size_t len) {
+    const uint8_t *p = buf;
+    while (len > 0) {
+        ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+        if (n <= 0) return -1;
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+static int recv_full(int fd, void *buf, size_t len) {
+    uint8_t *p = buf;
+    while (len > 0) {
+        ssize_t n = read(fd, p, len);
+        if (n <= 0) return -1;
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/**
+ * Envoie une requête à l'agent et lit sa réponse. Les entrées renvoyées
+ * (reply->count) sont allouées dans *entries, à effacer et libérer par
+ * l'appelant. Retourne -1 si l'échange échoue.
+ */
+int agent_call(int fd, uint32_t op, const PwEntry *entry, AgentReply *reply, PwEntry **entries) {
+    AgentRequest request;
+
+    memset(&request, 0, sizeof(request));
+    request.op = op;
+    if (entry != NULL) memcpy(&request.entry, entry, sizeof(PwEntry));
+
+    STATS_BEGIN(t_call);
+    int ret = send_full(fd, &request, sizeof(request));
+    memset(&request, 0, sizeof(request));
+    if (ret != 0 || recv_full(fd, reply, sizeof(AgentReply)) != 0) return -1;
+    STATS_END(t_call, "agent_call");
+
+    *entries = NULL;
+    if (reply->count == 0) return 0;
+    if (reply->count > VAULT_MAX_ENTRIES) return -1;
+
+    size_t len = (size_t)reply->count * sizeof(PwEntry);
+    *entries = malloc(len);
+    if (*entries == NULL || recv_full(fd, *entries, len) != 0) {
+        free(*entries);
+        *entries = NULL;
+        return -1;
+    }
+    for (uint32_t i = 0; i < reply->count; i++) {
+        (*entries)[i].name[MAX_NAME_LEN - 1] = '\0';
+        (*entries)[i].platform[MAX_PLATFORM_LEN - 1] = '\0';
+        (*entries)[i].user[MAX_USER_LEN - 1] = '\0';
+        (*entries)[i].password[MAX_PASSWORD_LEN - 1] = '\0';
+    }
+    return 0;
+}
+
+static void client_drop(Agent *agent, AgentClient *client) {
+    epoll_ctl(agent->epoll_fd, EPOLL_CTL_DEL, client->fd, NULL);
+    close(client->fd);
+    if (client->out != NULL) {
+        memset(client->out, 0, client->out_len);
+        free(client->out);
+    }
+    memset(client, 0, sizeof(AgentClient));
+    client->fd = -1;
+}
+
+// Prépare la réponse: AgentReply puis `count` entrées copiées depuis le coffre
+static int reply_alloc(AgentClient *client, uint32_t status, uint32_t count) {
+    client->out_len = sizeof(AgentReply) + (size_t)count * sizeof(PwEntry);
+    client->out = malloc(client->out_len);
+    if (client->out == NULL) return -1;
+
+    AgentReply *reply = (AgentReply *)client->out;
+    reply->status = status;
+    reply->count = count;
+    client->out_pos = 0;
+    return 0;
+}
+
+static PwEntry *reply_entries(AgentClient *client) {
+    return (PwEntry *)(client->out + sizeof(AgentReply));
+}
+
+static int agent_add(Agent *agent, const PwEntry *entry) {
+    if (entry->name[0] == '\0') return AGENT_FAILED;
+    if (vault_lookup(&agent->vault, entry->name) >= 0) return AGENT_EXISTS;
+
+    // Journal d'abord: l'entrée n'est visible qu'une fois écrite sur disque
+    if (vault_journal_append(agent->db_file, &agent->handle, entry) != 0) return AGENT_FAILED;
+
+    PwEntry *added = vault_append(&agent->vault, entry->name);
+    if (added == NULL) return AGENT_FAILED;
+    memcpy(added, entry, sizeof(PwEntry));
+    return AGENT_OK;
+}
+
+static int agent_handle_request(Agent *agent, AgentClient *client) {
+    AgentRequest *request = &client->request;
+    Vault *vault = &agent->vault;
+    int ret;
+
+    request->entry.name[MAX_NAME_LEN - 1] = '\0';
+    request->entry.platform[MAX_PLATFORM_LEN - 1] = '\0';
+    request->entry.user[MAX_USER_LEN - 1] = '\0';
+    request->entry.password[MAX_PASSWORD_LEN - 1] = '\0';
+
+    switch (request->op) {
+    case AGENT_OP_GET: {
+        int record = vault_lookup(vault, request->entry.name);
+        if (record < 0) {
+            ret = reply_alloc(client, AGENT_NOT_FOUND, 0);
+        } else if ((ret = reply_alloc(client, AGENT_OK, 1)) == 0) {
+            memcpy(reply_entries(client), &vault->entries[record], sizeof(PwEntry));
+        }
+        break;
+    }
+    case AGENT_OP_LIST:
+        ret = reply_alloc(client, AGENT_OK, (uint32_t)vault->count);
+        if (ret == 0) {
+            PwEntry *out = reply_entries(client);
+            memcpy(out, vault->entries, (size_t)vault->count * sizeof(PwEntry));
+            for (int i = 0; i < vault->count; i++) {
+                memset(out[i].password, 0, MAX_PASSWORD_LEN);
+            }
+        }
+        break;
+    case AGENT_OP_ADD:
+        ret = reply_alloc(client, (uint32_t)agent_add(agent, &request->entry), 0);
+        break;
+    case AGENT_OP_LOCK:
+        agent->running = 0;
+        ret = reply_alloc(client, AGENT_OK, 0);
+        break;
+    default:
+        ret = reply_alloc(client, AGENT_FAILED, 0);
+        break;
+    }
+
+    memset(request, 0, sizeof(AgentRequest));
+    client->in_len = 0;
+    return ret;
+}
+
+static void client_set_events(Agent *agent, AgentClient *client, unsigned int events) {
+    struct epoll_event ev;
+    if (client->events == events) return;
+    client->events = events;
+    ev.events = events;
+    ev.data = (unsigned long long)(client - agent->clients);
+    epoll_ctl(agent->epoll_fd, EPOLL_CTL_MOD, client->fd, &ev);
+}
+
+static void client_writable(Agent *agent, AgentClient *client);
+
+static void client_readable(Agent *agent, AgentClient *client) {
+    uint8_t *request = (uint8_t *)&client->request;
+
+    while (client->in_len < sizeof(AgentRequest)) {
+        ssize_t n = read(client->fd, request + client->in_len, sizeof(AgentRequest) - client->in_len);
+        if (n == -EAGAIN) return;
+        if (n == -EINTR) continue;
+        if (n <= 0) {
+            client_drop(agent, client);
+            return;
+        }
+        client->in_len += n;
+    }
+
+    if (agent_handle_request(agent, client) != 0) {
+        client_drop(agent, client);
+        return;
+    }
+    // La réponse part en général d'un coup, sans attendre EPOLLOUT
+    client_writable(agent, client);
+}
+
+static void client_writable(Agent *agent, AgentClient *client) {
+    while (client->out_pos < client->out_len) {
+        ssize_t n = send(client->fd, client->out + client->out_pos, client->out_len - client->out_pos, MSG_NOSIGNAL);
+        if (n == -EAGAIN) {
+            client_set_events(agent, client, EPOLLOUT);
+            return;
+        }
+        if (n == -EINTR) continue;
+        if (n <= 0) {
+            client_drop(agent, client);
+            return;
+        }
+        client->out_pos += n;
+    }
+
+    // Réponse envoyée: la connexion peut porter une nouvelle requête
+    memset(client->out, 0, client->out_len);
+    free(client->out);
+    client->out = NULL;
+    client->out_len = 0;
+    client->out_pos = 0;
+    client_set_events(agent, client, EPOLLIN);
+}
+
+static void agent_accept(Agent *agent) {
+    for (;;) {
+        int fd = accept4(agent->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd == -EINTR) continue;
+        if (fd < 0) return;
+
+        AgentClient *client = NULL;
+        for (int i = 0; i < AGENT_MAX_CLIENTS && client == NULL; i++) {
+            if (agent->clients[i].fd < 0) client = &agent->clients[i];
+        }
+        if (client == NULL) {
+            close(fd);
+            continue;
+        }
+
+        client->fd = fd;
+        client->in_len = 0;
+        client->events = EPOLLIN;
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data = (unsigned long long)(client - agent->clients);
+        if (epoll_ctl(agent->epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            close(fd);
+            client->fd = -1;
+        }
+    }
+}
+
+static void agent_loop(Agent *agent, int idle_seconds) {
+    struct epoll_event events[AGENT_MAX_EVENTS];
+
+    while (agent->running) {
+        int n = epoll_wait(agent->epoll_fd, events, AGENT_MAX_EVENTS, idle_seconds * 1000);
+        if (n == -EINTR) continue;
+        if (n <= 0) break; // délai d'inactivité écoulé (ou erreur)
+
+        for (int i = 0; i < n; i++) {
+            if (events[i].data == AGENT_LISTEN_ID) {
+                agent_accept(agent);
+                continue;
+            }
+
+            AgentClient *client = &agent->clients[events[i].data];
+            if (client->fd < 0) continue;
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                client_drop(agent, client);
+            } else if (events[i].events & EPOLLIN) {
+                client_readable(agent, client);
+            } else if (events[i].events & EPOLLOUT) {
+                client_writable(agent, client);
+            }
+        }
+    }
+}
+
+static int agent_listen(Agent *agent, const struct sockaddr_un *addr) {
+    agent->listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (agent->listen_fd < 0) return -1;
+
+    // Socket réservée au propriétaire du coffre
+    int old_mask = umask(077);
+    int ret = bind(agent->listen_fd, addr, sizeof(*addr));
+    umask(old_mask);
+    if (ret != 0 || listen(agent->listen_fd, AGENT_MAX_CLIENTS) != 0) return -1;
+
+    agent->epoll_fd = epoll_create1(0);
+    if (agent->epoll_fd < 0) return -1;
+
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data = AGENT_LISTEN_ID;
+    return epoll_ctl(agent->epoll_fd, EPOLL_CTL_ADD, agent->listen_fd, &ev);
+}
+
+// Le processus détaché n'a plus de terminal: entrées/sorties vers /dev/null
+static void agent_detach_stdio(void) {
+    int fd = open("/dev/null", O_RDWR, 0);
+    if (fd < 0) return;
+    dup2(fd, 0);
+    dup2(fd, 1);
+    dup2(fd, 2);
+    if (fd > 2) close(fd);
+}
+
+/**
+ * Déverrouille le coffre, écoute sur "<db_file>.sock" puis passe en
+ * arrière-plan. Le processus parent retourne 0 une fois l'agent prêt.
+ */
+int agent_run(const char *db_file, const char *master_password, int idle_seconds) {
+    static Agent agent;
+    struct sockaddr_un addr;
+
+    if (agent_socket_path(db_file, &addr) != 0) {
+        puts("Error: Vault path too long for the agent socket.\n");
+        return -1;
+    }
+
+    int probe = agent_connect(db_file);
+    if (probe >= 0) {
+        close(probe);
+        printf("Error: An agent is already running on '%s'.\n", addr.sun_path);
+        return -1;
+    }
+    unlink(addr.sun_path); // socket d'un agent disparu
+
+    memset(&agent, 0, sizeof(agent));
+    agent.db_file = db_file;
+    agent.epoll_fd = -1;
+    agent.listen_fd = -1;
+    agent.running = 1;
+    for (int i = 0; i < AGENT_MAX_CLIENTS; i++) agent.clients[i].fd = -1;
+
+    if (vault_open(db_file, &agent.handle, master_password) != 0) {
+        return -1;
+    }
+    if (vault_load_entries(&agent.handle, &agent.vault) != 0) {
+        vault_close(&agent.handle);
+        return -1;
+    }
+
+    int ret = agent_listen(&agent, &addr);
+    int pid = -1;
+    if (ret == 0) {
+        printf("Agent unlocked '%s' (%d entries), listening on '%s'.\n", db_file, agent.vault.count, addr.sun_path);
+        stdout_flush();
+        pid = fork();
+    }
+
+    if (pid == 0) {
+        setsid();
+        agent_detach_stdio();
+        agent_loop(&agent, idle_seconds);
+
+        for (int i = 0; i < AGENT_MAX_CLIENTS; i++) {
+            if (agent.clients[i].fd >= 0) client_drop(&agent, &agent.clients[i]);
+        }
+        unlink(addr.sun_path);
+    } else if (pid < 0 && ret == 0) {
+        unlink(addr.sun_path);
+        ret = -1;
+    }
+
+    if (agent.epoll_fd >= 0) close(agent.epoll_fd);
+    if (agent.listen_fd >= 0) close(agent.listen_fd);
+    vault_free(&agent.vault);
+    vault_close(&agent.handle);
+
+    if (ret != 0) {
+        puts("Error: Cannot start the agent.\n");
+    }
+    return ret;
+}
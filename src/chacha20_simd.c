@@ -0,0 +1,147 @@
+#include "pwman.h"
+
+/*
+ * Noyaux ChaCha20 multi-blocs (SSE2: 4 blocs, AVX2: 8 blocs).
+ *
+ * Chaque vecteur x[i] contient le mot i de l'état pour N blocs consécutifs
+ * (un bloc par voie), ce qui permet d'exécuter les rounds sans permutation.
+ * Les mots sont ensuite transposés pour XOR le keystream par vecteurs entiers.
+ * Le code scalaire de crypto.c reste la référence.
+ */
+
+typedef uint32_t v4u __attribute__((vector_size(16)));
+typedef uint32_t v4u_unaligned __attribute__((vector_size(16), aligned(1), may_alias));
+typedef uint32_t v8u __attribute__((vector_size(32)));
+typedef uint32_t v8u_unaligned __attribute__((vector_size(32), aligned(1), may_alias));
+
+#define ROTL_V(v, n) (((v) << (n)) | ((v) >> (32 - (n))))
+
+#define CHACHA20_QUARTERROUND_V(x, a, b, c, d) \
+    x[a] += x[b]; x[d] = ROTL_V(x[d] ^ x[a], 16); \
+    x[c] += x[d]; x[b] = ROTL_V(x[b] ^ x[c], 12); \
+    x[a] += x[b]; x[d] = ROTL_V(x[d] ^ x[a], 8); \
+    x[c] += x[d]; x[b] = ROTL_V(x[b] ^ x[c], 7);
+
+#define CHACHA20_DOUBLEROUND_V(x) \
+    CHACHA20_QUARTERROUND_V(x, 0, 4, 8, 12) \
+    CHACHA20_QUARTERROUND_V(x, 1, 5, 9, 13) \
+    CHACHA20_QUARTERROUND_V(x, 2, 6, 10, 14) \
+    CHACHA20_QUARTERROUND_V(x, 3, 7, 11, 15) \
+    CHACHA20_QUARTERROUND_V(x, 0, 5, 10, 15) \
+    CHACHA20_QUARTERROUND_V(x, 1, 6, 11, 12) \
+    CHACHA20_QUARTERROUND_V(x, 2, 7, 8, 13) \
+    CHACHA20_QUARTERROUND_V(x, 3, 4, 9, 14)
+
+// Compteur de bloc sur 64 bits (state[12] + report dans state[13], comme le scalaire)
+static uint64_t load_counter(const uint32_t state[16]) {
+    return (uint64_t)state[12] | ((uint64_t)state[13] << 32);
+}
+
+static void store_counter(uint32_t state[16], uint64_t counter) {
+    state[12] = (uint32_t)counter;
+    state[13] = (uint32_t)(counter >> 32);
+}
+
+/**
+ * XOR n_blocks (multiple de 4) blocs de keystream dans bytes et avance le compteur.
+ */
+void chacha20_xor_blocks_sse2(uint32_t state[16], uint8_t *bytes, size_t n_blocks) {
+    uint64_t counter = load_counter(state);
+
+    while (n_blocks >= 4) {
+        v4u s[16], x[16];
+
+        for (int i = 0; i < 16; i++) {
+            s[i] = (v4u){ state[i], state[i], state[i], state[i] };
+        }
+        for (int j = 0; j < 4; j++) {
+            s[12][j] = (uint32_t)(counter + j);
+            s[13][j] = (uint32_t)((counter + j) >> 32);
+        }
+        for (int i = 0; i < 16; i++) x[i] = s[i];
+
+        for (int i = 0; i < 10; i++) {
+            CHACHA20_DOUBLEROUND_V(x)
+        }
+
+        for (int i = 0; i < 16; i++) x[i] += s[i];
+
+        // Transposition 4x4 par groupe de 4 mots: voie j -> bloc j
+        for (int g = 0; g < 4; g++) {
+            v4u t0 = __builtin_shuffle(x[4*g + 0], x[4*g + 1], (v4u){ 0, 4, 1, 5 });
+            v4u t1 = __builtin_shuffle(x[4*g + 2], x[4*g + 3], (v4u){ 0, 4, 1, 5 });
+            v4u t2 = __builtin_shuffle(x[4*g + 0], x[4*g + 1], (v4u){ 2, 6, 3, 7 });
+            v4u t3 = __builtin_shuffle(x[4*g + 2], x[4*g + 3], (v4u){ 2, 6, 3, 7 });
+
+            *(v4u_unaligned *)(bytes + 0 * 64 + 16 * g) ^= __builtin_shuffle(t0, t1, (v4u){ 0, 1, 4, 5 });
+            *(v4u_unaligned *)(bytes + 1 * 64 + 16 * g) ^= __builtin_shuffle(t0, t1, (v4u){ 2, 3, 6, 7 });
+            *(v4u_unaligned *)(bytes + 2 * 64 + 16 * g) ^= __builtin_shuffle(t2, t3, (v4u){ 0, 1, 4, 5 });
+            *(v4u_unaligned *)(bytes + 3 * 64 + 16 * g) ^= __builtin_shuffle(t2, t3, (v4u){ 2, 3, 6, 7 });
+        }
+
+        bytes += 4 * 64;
+        n_blocks -= 4;
+        counter += 4;
+    }
+
+    store_counter(state, counter);
+}
+
+/**
+ * XOR n_blocks (multiple de 8) blocs de keystream dans bytes et avance le compteur.
+ */
+__attribute__((target("avx2")))
+void chacha20_xor_blocks_avx2(uint32_t state[16], uint8_t *bytes, size_t n_blocks) {
+    uint64_t counter = load_counter(state);
+
+    while (n_blocks >= 8) {
+        v8u s[16], x[16], u[4][4];
+
+        for (int i = 0; i < 16; i++) {
+            uint32_t w = state[i];
+            s[i] = (v8u){ w, w, w, w, w, w, w, w };
+        }
+        for (int j = 0; j < 8; j++) {
+            s[12][j] = (uint32_t)(counter + j);
+            s[13][j] = (uint32_t)((counter + j) >> 32);
+        }
+        for (int i = 0; i < 16; i++) x[i] = s[i];
+
+        for (int i = 0; i < 10; i++) {
+            CHACHA20_DOUBLEROUND_V(x)
+        }
+
+        for (int i = 0; i < 16; i++) x[i] += s[i];
+
+        // Transposition 4x4 dans chaque moitié de 128 bits:
+        // u[g][j] = mots 4g..4g+3 du bloc j (bas) et du bloc j+4 (haut)
+        for (int g = 0; g < 4; g++) {
+            v8u t0 = __builtin_shuffle(x[4*g + 0], x[4*g + 1], (v8u){ 0, 8, 1, 9, 4, 12, 5, 13 });
+            v8u t1 = __builtin_shuffle(x[4*g + 2], x[4*g + 3], (v8u){ 0, 8, 1, 9, 4, 12, 5, 13 });
+            v8u t2 = __builtin_shuffle(x[4*g + 0], x[4*g + 1], (v8u){ 2, 10, 3, 11, 6, 14, 7, 15 });
+            v8u t3 = __builtin_shuffle(x[4*g + 2], x[4*g + 3], (v8u){ 2, 10, 3, 11, 6, 14, 7, 15 });
+
+            u[g][0] = __builtin_shuffle(t0, t1, (v8u){ 0, 1, 8, 9, 4, 5, 12, 13 });
+            u[g][1] = __builtin_shuffle(t0, t1, (v8u){ 2, 3, 10, 11, 6, 7, 14, 15 });
+            u[g][2] = __builtin_shuffle(t2, t3, (v8u){ 0, 1, 8, 9, 4, 5, 12, 13 });
+            u[g][3] = __builtin_shuffle(t2, t3, (v8u){ 2, 3, 10, 11, 6, 7, 14, 15 });
+        }
+
+        // Recombine les moitiés: 32 octets contigus du même bloc par vecteur
+        for (int j = 0; j < 4; j++) {
+            for (int h = 0; h < 2; h++) {
+                v8u lo = __builtin_shuffle(u[2*h][j], u[2*h + 1][j], (v8u){ 0, 1, 2, 3, 8, 9, 10, 11 });
+                v8u hi = __builtin_shuffle(u[2*h][j], u[2*h + 1][j], (v8u){ 4, 5, 6, 7, 12, 13, 14, 15 });
+
+                *(v8u_unaligned *)(bytes + j * 64 + 32 * h) ^= lo;
+                *(v8u_unaligned *)(bytes + (j + 4) * 64 + 32 * h) ^= hi;
+            }
+        }
+
+        bytes += 8 * 64;
+        n_blocks -= 8;
+        counter += 8;
+    }
+
+    store_counter(state, counter);
+}
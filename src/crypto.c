@@ -46,18 +46,6 @@ static void chacha20_block_next(struct chacha20_context *ctx) {
 }
 
 
-/**
- * Prépare une clé de 32 octets (MASTER_KEY_LEN) à partir d'un mot de passe.
- * Tronque ou complète avec des zéros pour atteindre la taille requise.
- */
-void normalize_key(const char *password, uint8_t *key_buffer) {
-    size_t pass_len = strlen(password);
-    size_t len_to_copy = (pass_len < MASTER_KEY_LEN) ? pass_len : MASTER_KEY_LEN;
-
-    memcpy(key_buffer, password, len_to_copy);
-    memset(key_buffer + len_to_copy, 0, MASTER_KEY_LEN - len_to_copy);
-}
-
 /**
  * Initialise l'état interne de ChaCha20 avec la clé, le nonce et un compteur.
  */
@@ -81,18 +69,504 @@ void chacha20_init_context(struct chacha20_context *ctx, const uint8_t key[], co
     ctx->position = 64; // Force la génération d'un nouveau bloc au premier appel
 }
 
+/**
+ * Positionne le keystream sur l'octet `offset` (relatif au compteur 0),
+ * pour déchiffrer une portion du flux sans traiter ce qui précède.
+ */
+void chacha20_seek(struct chacha20_context *ctx, uint64_t offset) {
+    ctx->state[12] = (uint32_t)(offset / 64);
+    ctx->position = 64;
+
+    if (offset % 64 != 0) {
+        chacha20_block_next(ctx);
+        ctx->position = offset % 64;
+    }
+}
+
+/**
+ * Dérive une sous-clé de `len` octets depuis la clé maître.
+ * Le label (12 caractères max) sert de nonce fixe, distinct des nonces
+ * aléatoires du chiffrement: chaque usage obtient un keystream séparé.
+ */
+void derive_subkey(const uint8_t key[], const char *label, uint8_t *out, size_t len) {
+    uint8_t nonce[CHACHA20_NONCE_LEN];
+    struct chacha20_context ctx;
+    size_t label_len = strlen(label);
+
+    if (label_len > CHACHA20_NONCE_LEN) label_len = CHACHA20_NONCE_LEN;
+    memset(nonce, 0, CHACHA20_NONCE_LEN);
+    memcpy(nonce, label, label_len);
+
+    memset(out, 0, len);
+    chacha20_init_context(&ctx, key, nonce, 0);
+    chacha20_xor(&ctx, out, len);
+    memset(&ctx, 0, sizeof(ctx));
+}
+
+#define SIPROUND(v0, v1, v2, v3) \
+    v0 += v1; v1 = rotl64(v1, 13); v1 ^= v0; v0 = rotl64(v0, 32); \
+    v2 += v3; v3 = rotl64(v3, 16); v3 ^= v2; \
+    v0 += v3; v3 = rotl64(v3, 21); v3 ^= v0; \
+    v2 += v1; v1 = rotl64(v1, 17); v1 ^= v2; v2 = rotl64(v2, 32);
+
+static uint64_t rotl64(uint64_t x, int n) {
+    return (x << n) | (x >> (64 - n));
+}
+
+static uint64_t pack8(const uint8_t *a) {
+    return (uint64_t)pack4(a) | ((uint64_t)pack4(a + 4) << 32);
+}
+
+/**
+ * SipHash-2-4: hash à clé de 128 bits, utilisé pour l'index des noms.
+ * Sans la clé, on ne peut ni prédire les cases ni provoquer de collisions.
+ */
+uint64_t siphash24(const uint8_t key[INDEX_KEY_LEN], const void *data, size_t len) {
+    const uint8_t *in = data;
+    uint64_t k0 = pack8(key), k1 = pack8(key + 8);
+    uint64_t v0 = 0x736f6d6570736575ULL ^ k0;
+    uint64_t v1 = 0x646f72616e646f6dULL ^ k1;
+    uint64_t v2 = 0x6c7967656e657261ULL ^ k0;
+    uint64_t v3 = 0x7465646279746573ULL ^ k1;
+    uint64_t b = (uint64_t)len << 56;
+
+    for (; len >= 8; len -= 8, in += 8) {
+        uint64_t m = pack8(in);
+        v3 ^= m;
+        SIPROUND(v0, v1, v2, v3)
+        SIPROUND(v0, v1, v2, v3)
+        v0 ^= m;
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        b |= (uint64_t)in[i] << (8 * i);
+    }
+
+    v3 ^= b;
+    SIPROUND(v0, v1, v2, v3)
+    SIPROUND(v0, v1, v2, v3)
+    v0 ^= b;
+
+    v2 ^= 0xff;
+    SIPROUND(v0, v1, v2, v3)
+    SIPROUND(v0, v1, v2, v3)
+    SIPROUND(v0, v1, v2, v3)
+    SIPROUND(v0, v1, v2, v3)
+
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+// Chemin multi-blocs choisi au premier appel selon cpuid (NULL = scalaire seul)
+typedef void (*chacha20_blocks_fn)(uint32_t state[16], uint8_t *bytes, size_t n_blocks);
+
+static chacha20_blocks_fn chacha20_wide_xor = NULL;
+static size_t chacha20_wide_blocks = 0;
+static int chacha20_dispatched = 0;
+
+static void chacha20_dispatch(void) {
+    unsigned int features = cpu_features();
+
+    if (features & CPU_FEATURE_AVX2) {
+        chacha20_wide_xor = chacha20_xor_blocks_avx2;
+        chacha20_wide_blocks = 8;
+    } else if (features & CPU_FEATURE_SSE2) {
+        chacha20_wide_xor = chacha20_xor_blocks_sse2;
+        chacha20_wide_blocks = 4;
+    }
+    chacha20_dispatched = 1;
+}
+
+// XOR d'un bloc complet de keystream, 8 octets à la fois
+static void xor_block64(uint8_t *bytes, const uint32_t keystream32[16]) {
+    typedef uint64_t __attribute__((aligned(1), may_alias)) unaligned_u64;
+    unaligned_u64 *dst = (unaligned_u64 *)bytes;
+    const uint64_t *src = (const uint64_t *)keystream32;
+
+    for (int i = 0; i < 8; i++) dst[i] ^= src[i];
+}
+
 /**
  * Applique l'opération XOR entre le keystream ChaCha20 et un buffer de données.
  * C'est la fonction qui chiffre et déchiffre.
+ * Les blocs complets passent par le noyau SIMD quand le CPU le permet.
  */
 void chacha20_xor(struct chacha20_context *ctx, uint8_t *bytes, size_t n_bytes) {
     uint8_t *keystream8 = (uint8_t*)ctx->keystream32;
-    for (size_t i = 0; i < n_bytes; i++) {
-        if (ctx->position >= 64) {
-            chacha20_block_next(ctx);
-            ctx->position = 0;
+
+    if (!chacha20_dispatched) chacha20_dispatch();
+
+    // Termine le bloc de keystream entamé
+    while (n_bytes > 0 && ctx->position < 64) {
+        *bytes++ ^= keystream8[ctx->position++];
+        n_bytes--;
+    }
+
+    if (chacha20_wide_xor != NULL) {
+        size_t n_blocks = (n_bytes / 64) / chacha20_wide_blocks * chacha20_wide_blocks;
+        if (n_blocks > 0) {
+            chacha20_wide_xor(ctx->state, bytes, n_blocks);
+            bytes += n_blocks * 64;
+            n_bytes -= n_blocks * 64;
         }
-        bytes[i] ^= keystream8[ctx->position];
-        ctx->position++;
     }
-}
\ No newline at end of file
+
+    while (n_bytes >= 64) {
+        chacha20_block_next(ctx);
+        xor_block64(bytes, ctx->keystream32);
+        bytes += 64;
+        n_bytes -= 64;
+    }
+
+    if (n_bytes > 0) {
+        chacha20_block_next(ctx);
+        ctx->position = 0;
+        while (n_bytes > 0) {
+            *bytes++ ^= keystream8[ctx->position++];
+            n_bytes--;
+        }
+    }
+}
+
+/*
+ * Chiffrement parallèle: les blocs de keystream ne dépendent que du
+ * compteur, donc chaque tranche de blocs est traitée par le pool avec sa
+ * propre copie du contexte, compteur avancé d'autant. Les tranches ne font
+ * que du calcul (ni malloc ni printf). En dessous de quelques centaines de
+ * Ko, réveiller un worker coûte plus que chiffrer.
+ */
+
+#define CHACHA20_PARALLEL_GRAIN (256 * 1024 / 64)   // blocs par tranche au minimum
+
+typedef struct {
+    const struct chacha20_context *base;   // positionné sur le bloc 0 de bytes
+    uint8_t *bytes;
+} chacha20_job;
+
+// Avance le compteur de n blocs, avec le même report que chacha20_block_next
+static void chacha20_skip_blocks(struct chacha20_context *ctx, uint64_t n) {
+    uint64_t counter = ((uint64_t)ctx->state[13] << 32 | ctx->state[12]) + n;
+    ctx->state[12] = (uint32_t)counter;
+    ctx->state[13] = (uint32_t)(counter >> 32);
+}
+
+static void chacha20_xor_range(void *arg, size_t first, size_t end) {
+    chacha20_job *job = arg;
+    struct chacha20_context ctx = *job->base;
+
+    chacha20_skip_blocks(&ctx, first);
+    chacha20_xor(&ctx, job->bytes + first * 64, (end - first) * 64);
+    memset(&ctx, 0, sizeof(ctx));
+}
+
+/**
+ * Comme chacha20_xor, mais répartit les blocs complets d'un gros buffer
+ * sur les threads du pool. Le keystream produit et la suite du flux sont
+ * identiques à ceux de chacha20_xor.
+ */
+void chacha20_xor_parallel(struct chacha20_context *ctx, uint8_t *bytes, size_t n_bytes) {
+    if (!chacha20_dispatched) chacha20_dispatch();
+
+    if (n_bytes < 2 * CHACHA20_PARALLEL_GRAIN * 64) {
+        chacha20_xor(ctx, bytes, n_bytes);
+        return;
+    }
+
+    // Le bloc entamé est fini ici: chaque tranche commence sur un bloc neuf
+    size_t head = 64 - ctx->position;
+    chacha20_xor(ctx, bytes, head);
+    bytes += head;
+    n_bytes -= head;
+
+    size_t n_blocks = n_bytes / 64;
+    chacha20_job job = { ctx, bytes };
+    pool_parallel_for(0, n_blocks, CHACHA20_PARALLEL_GRAIN, chacha20_xor_range, &job);
+
+    chacha20_skip_blocks(ctx, n_blocks);
+    chacha20_xor(ctx, bytes + n_blocks * 64, n_bytes % 64);
+}
+
+/*
+ * Poly1305 (RFC 8439), en limbs de 26 bits: h et r sont des entiers modulo
+ * p = 2^130 - 5 répartis sur 5 mots de 32 bits, ce qui garde chaque produit
+ * partiel sur 64 bits. Le noyau AVX2 (poly1305_simd.c) traite 4 blocs à la
+ * fois avec r^4; ce code scalaire reste la référence.
+ */
+
+#define POLY1305_MASK 0x3ffffff
+
+typedef void (*poly1305_blocks_fn)(uint32_t h[5], const uint32_t r_pow[4][5], const uint8_t *m, size_t n_blocks);
+
+static poly1305_blocks_fn poly1305_wide_blocks = NULL;
+static int poly1305_dispatched = 0;
+
+static void poly1305_dispatch(void) {
+    if (cpu_features() & CPU_FEATURE_AVX2) {
+        poly1305_wide_blocks = poly1305_blocks_avx2;
+    }
+    poly1305_dispatched = 1;
+}
+
+// h = h * r mod p (réduction partielle: chaque limb < 2^26, sauf h[1] un peu plus)
+static void poly1305_mul(uint32_t h[5], const uint32_t r[5]) {
+    uint64_t s1 = (uint64_t)r[1] * 5, s2 = (uint64_t)r[2] * 5;
+    uint64_t s3 = (uint64_t)r[3] * 5, s4 = (uint64_t)r[4] * 5;
+
+    uint64_t d0 = h[0] * (uint64_t)r[0] + h[1] * s4 + h[2] * s3 + h[3] * s2 + h[4] * s1;
+    uint64_t d1 = h[0] * (uint64_t)r[1] + h[1] * (uint64_t)r[0] + h[2] * s4 + h[3] * s3 + h[4] * s2;
+    uint64_t d2 = h[0] * (uint64_t)r[2] + h[1] * (uint64_t)r[1] + h[2] * (uint64_t)r[0] + h[3] * s4 + h[4] * s3;
+    uint64_t d3 = h[0] * (uint64_t)r[3] + h[1] * (uint64_t)r[2] + h[2] * (uint64_t)r[1] + h[3] * (uint64_t)r[0] + h[4] * s4;
+    uint64_t d4 = h[0] * (uint64_t)r[4] + h[1] * (uint64_t)r[3] + h[2] * (uint64_t)r[2] + h[3] * (uint64_t)r[1] + h[4] * (uint64_t)r[0];
+
+    d1 += d0 >> 26; h[0] = (uint32_t)d0 & POLY1305_MASK;
+    d2 += d1 >> 26; h[1] = (uint32_t)d1 & POLY1305_MASK;
+    d3 += d2 >> 26; h[2] = (uint32_t)d2 & POLY1305_MASK;
+    d4 += d3 >> 26; h[3] = (uint32_t)d3 & POLY1305_MASK;
+    uint64_t t = h[0] + (d4 >> 26) * 5; h[4] = (uint32_t)d4 & POLY1305_MASK;
+    h[0] = (uint32_t)t & POLY1305_MASK;
+    h[1] += (uint32_t)(t >> 26);
+}
+
+// Absorbe des blocs de 16 octets; hibit vaut 1 << 24 sauf pour le dernier bloc partiel
+static void poly1305_blocks(struct poly1305_context *ctx, const uint8_t *m, size_t n_blocks, uint32_t hibit) {
+    for (; n_blocks > 0; n_blocks--, m += 16) {
+        ctx->h[0] += pack4(m + 0) & POLY1305_MASK;
+        ctx->h[1] += (pack4(m + 3) >> 2) & POLY1305_MASK;
+        ctx->h[2] += (pack4(m + 6) >> 4) & POLY1305_MASK;
+        ctx->h[3] += (pack4(m + 9) >> 6) & POLY1305_MASK;
+        ctx->h[4] += (pack4(m + 12) >> 8) | hibit;
+        poly1305_mul(ctx->h, ctx->r_pow[0]);
+    }
+}
+
+/**
+ * Initialise Poly1305 avec une clé à usage unique (r puis s, 16 octets chacun).
+ */
+void poly1305_init(struct poly1305_context *ctx, const uint8_t key[POLY1305_KEY_LEN]) {
+    memset(ctx, 0, sizeof(struct poly1305_context));
+
+    // r "clampé" (RFC 8439 §2.5), directement en limbs de 26 bits
+    ctx->r_pow[0][0] = pack4(key + 0) & 0x3ffffff;
+    ctx->r_pow[0][1] = (pack4(key + 3) >> 2) & 0x3ffff03;
+    ctx->r_pow[0][2] = (pack4(key + 6) >> 4) & 0x3ffc0ff;
+    ctx->r_pow[0][3] = (pack4(key + 9) >> 6) & 0x3f03fff;
+    ctx->r_pow[0][4] = (pack4(key + 12) >> 8) & 0x00fffff;
+
+    // r^2, r^3, r^4 pour le noyau 4 blocs
+    for (int i = 1; i < 4; i++) {
+        memcpy(ctx->r_pow[i], ctx->r_pow[i - 1], sizeof(ctx->r_pow[i]));
+        poly1305_mul(ctx->r_pow[i], ctx->r_pow[0]);
+    }
+
+    for (int i = 0; i < 4; i++) ctx->pad[i] = pack4(key + 16 + 4 * i);
+}
+
+/**
+ * Absorbe len octets. Les blocs complets passent par le noyau AVX2 quand le
+ * CPU le permet, par groupes de 4.
+ */
+void poly1305_update(struct poly1305_context *ctx, const uint8_t *m, size_t len) {
+    if (!poly1305_dispatched) poly1305_dispatch();
+
+    // Complète le bloc entamé
+    if (ctx->leftover > 0) {
+        size_t want = 16 - ctx->leftover;
+        if (want > len) want = len;
+        memcpy(ctx->buffer + ctx->leftover, m, want);
+        ctx->leftover += want;
+        m += want;
+        len -= want;
+        if (ctx->leftover < 16) return;
+        poly1305_blocks(ctx, ctx->buffer, 1, 1 << 24);
+        ctx->leftover = 0;
+    }
+
+    size_t n_blocks = len / 16;
+    if (poly1305_wide_blocks != NULL && n_blocks >= 4) {
+        size_t wide = n_blocks & ~(size_t)3;
+        poly1305_wide_blocks(ctx->h, (const uint32_t (*)[5])ctx->r_pow, m, wide);
+        m += wide * 16;
+        len -= wide * 16;
+        n_blocks -= wide;
+    }
+    poly1305_blocks(ctx, m, n_blocks, 1 << 24);
+    m += n_blocks * 16;
+    len -= n_blocks * 16;
+
+    memcpy(ctx->buffer, m, len);
+    ctx->leftover = len;
+}
+
+/**
+ * Termine le calcul: tag = (h mod p) + s mod 2^128. Le contexte est effacé.
+ */
+void poly1305_finish(struct poly1305_context *ctx, uint8_t tag[POLY1305_TAG_LEN]) {
+    uint32_t *h = ctx->h;
+    uint32_t g[5];
+
+    if (ctx->leftover > 0) {
+        ctx->buffer[ctx->leftover] = 1;
+        memset(ctx->buffer + ctx->leftover + 1, 0, 16 - ctx->leftover - 1);
+        poly1305_blocks(ctx, ctx->buffer, 1, 0);
+    }
+
+    // Propagation complète des retenues
+    uint32_t c;
+    c = h[1] >> 26; h[1] &= POLY1305_MASK; h[2] += c;
+    c = h[2] >> 26; h[2] &= POLY1305_MASK; h[3] += c;
+    c = h[3] >> 26; h[3] &= POLY1305_MASK; h[4] += c;
+    c = h[4] >> 26; h[4] &= POLY1305_MASK; h[0] += c * 5;
+    c = h[0] >> 26; h[0] &= POLY1305_MASK; h[1] += c;
+
+    // g = h - p; on garde g si h >= p, sans branchement
+    g[0] = h[0] + 5; c = g[0] >> 26; g[0] &= POLY1305_MASK;
+    g[1] = h[1] + c; c = g[1] >> 26; g[1] &= POLY1305_MASK;
+    g[2] = h[2] + c; c = g[2] >> 26; g[2] &= POLY1305_MASK;
+    g[3] = h[3] + c; c = g[3] >> 26; g[3] &= POLY1305_MASK;
+    g[4] = h[4] + c - (1 << 26);
+
+    uint32_t keep_g = (g[4] >> 31) - 1;
+    for (int i = 0; i < 5; i++) h[i] = (h[i] & ~keep_g) | (g[i] & keep_g);
+
+    // Repasse en 4 mots de 32 bits et ajoute s
+    uint32_t w[4];
+    w[0] = h[0] | (h[1] << 26);
+    w[1] = (h[1] >> 6) | (h[2] << 20);
+    w[2] = (h[2] >> 12) | (h[3] << 14);
+    w[3] = (h[3] >> 18) | (h[4] << 8);
+
+    uint64_t f = 0;
+    for (int i = 0; i < 4; i++) {
+        f = (uint64_t)w[i] + ctx->pad[i] + (f >> 32);
+        tag[4 * i + 0] = (uint8_t)f;
+        tag[4 * i + 1] = (uint8_t)(f >> 8);
+        tag[4 * i + 2] = (uint8_t)(f >> 16);
+        tag[4 * i + 3] = (uint8_t)(f >> 24);
+    }
+
+    memset(ctx, 0, sizeof(struct poly1305_context));
+    memset(g, 0, sizeof(g));
+    memset(w, 0, sizeof(w));
+}
+
+/**
+ * Compare deux tags en temps constant: 0 s'ils sont égaux.
+ */
+int poly1305_verify(const uint8_t a[POLY1305_TAG_LEN], const uint8_t b[POLY1305_TAG_LEN]) {
+    uint8_t diff = 0;
+    for (int i = 0; i < POLY1305_TAG_LEN; i++) diff |= a[i] ^ b[i];
+    return diff ? -1 : 0;
+}
+
+/*
+ * KDF à mémoire dure, construite comme scrypt à partir du cœur ChaCha:
+ * 1. Absorption: sel, mot de passe et sa longueur sont XORés par morceaux
+ *    de 32 octets dans un état qui sert de clé ChaCha20; le keystream
+ *    (nonce fixe) donne l'état suivant.
+ * 2. L'état est étendu en un bloc X de KDF_BLOCK_LEN octets.
+ * 3. Remplissage: V[i] = X puis X = mix(X), pour les m_cost blocs de 1 Kio.
+ * 4. t_cost passes de m_cost lectures dépendantes des données:
+ *    j = X mod m_cost, X = mix(X ^ V[j]), V[j] = X.
+ * 5. X est absorbé pour donner la clé maître.
+ * mix() est le BlockMix de scrypt avec le cœur ChaCha à 8 rounds à la
+ * place de Salsa20/8.
+ */
+
+#define KDF_BLOCK_LEN 1024
+#define KDF_BLOCK_WORDS (KDF_BLOCK_LEN / 4)
+
+static void kdf_absorb(uint8_t state[MASTER_KEY_LEN], const uint8_t *data, size_t len) {
+    static const uint8_t nonce[CHACHA20_NONCE_LEN] = "pwman-kdf";
+    struct chacha20_context ctx;
+    uint8_t next[MASTER_KEY_LEN];
+
+    while (len > 0) {
+        size_t n = (len < MASTER_KEY_LEN) ? len : MASTER_KEY_LEN;
+        for (size_t i = 0; i < n; i++) state[i] ^= data[i];
+
+        memset(next, 0, MASTER_KEY_LEN);
+        chacha20_init_context(&ctx, state, nonce, 0);
+        chacha20_xor(&ctx, next, MASTER_KEY_LEN);
+        memcpy(state, next, MASTER_KEY_LEN);
+
+        data += n;
+        len -= n;
+    }
+    memset(next, 0, sizeof(next));
+    memset(&ctx, 0, sizeof(ctx));
+}
+
+// Cœur ChaCha à 8 rounds avec réinjection de l'entrée, sur un sous-bloc de 64 octets
+static void kdf_core(uint32_t b[16]) {
+    uint32_t x[16];
+
+    for (int i = 0; i < 16; i++) x[i] = b[i];
+    for (int i = 0; i < 4; i++) {
+        CHACHA20_QUARTERROUND(x, 0, 4, 8, 12)
+        CHACHA20_QUARTERROUND(x, 1, 5, 9, 13)
+        CHACHA20_QUARTERROUND(x, 2, 6, 10, 14)
+        CHACHA20_QUARTERROUND(x, 3, 7, 11, 15)
+        CHACHA20_QUARTERROUND(x, 0, 5, 10, 15)
+        CHACHA20_QUARTERROUND(x, 1, 6, 11, 12)
+        CHACHA20_QUARTERROUND(x, 2, 7, 8, 13)
+        CHACHA20_QUARTERROUND(x, 3, 4, 9, 14)
+    }
+    for (int i = 0; i < 16; i++) b[i] += x[i];
+}
+
+static void kdf_mix(uint32_t x[KDF_BLOCK_WORDS]) {
+    uint32_t t[16];
+
+    for (int i = 0; i < 16; i++) t[i] = x[KDF_BLOCK_WORDS - 16 + i];
+    for (int sub = 0; sub < KDF_BLOCK_WORDS; sub += 16) {
+        for (int i = 0; i < 16; i++) t[i] ^= x[sub + i];
+        kdf_core(t);
+        for (int i = 0; i < 16; i++) x[sub + i] = t[i];
+    }
+}
+
+/**
+ * Dérive la clé maître du mot de passe, du sel et des paramètres de coût
+ * (m_cost en Kio, t_cost passes). Retourne -1 si la mémoire manque.
+ */
+int kdf_derive(const char *password, const uint8_t salt[KDF_SALT_LEN], const KdfParams *params, uint8_t key[MASTER_KEY_LEN]) {
+    static const uint8_t expand_nonce[CHACHA20_NONCE_LEN] = "pwman-kdf-x";
+    struct chacha20_context ctx;
+    uint32_t x[KDF_BLOCK_WORDS];
+    uint64_t pass_len = strlen(password);
+    uint32_t m = params->m_cost;
+
+    uint32_t *v = malloc((size_t)m * KDF_BLOCK_LEN);
+    if (v == NULL) return -1;
+
+    memset(key, 0, MASTER_KEY_LEN);
+    kdf_absorb(key, salt, KDF_SALT_LEN);
+    kdf_absorb(key, (const uint8_t *)password, pass_len);
+    kdf_absorb(key, (const uint8_t *)&pass_len, sizeof(pass_len));
+    kdf_absorb(key, (const uint8_t *)params, sizeof(KdfParams));
+
+    memset(x, 0, sizeof(x));
+    chacha20_init_context(&ctx, key, expand_nonce, 0);
+    chacha20_xor(&ctx, (uint8_t *)x, sizeof(x));
+
+    for (uint32_t i = 0; i < m; i++) {
+        memcpy(&v[(size_t)i * KDF_BLOCK_WORDS], x, KDF_BLOCK_LEN);
+        kdf_mix(x);
+    }
+
+    for (uint64_t n = (uint64_t)m * params->t_cost; n > 0; n--) {
+        const uint32_t *last = &x[KDF_BLOCK_WORDS - 16];
+        uint32_t *vj = &v[(size_t)((((uint64_t)last[1] << 32) | last[0]) % m) * KDF_BLOCK_WORDS];
+
+        for (int i = 0; i < KDF_BLOCK_WORDS; i++) x[i] ^= vj[i];
+        kdf_mix(x);
+        memcpy(vj, x, KDF_BLOCK_LEN);
+    }
+
+    kdf_absorb(key, (const uint8_t *)x, sizeof(x));
+
+    memset(v, 0, (size_t)m * KDF_BLOCK_LEN);
+    free(v);
+    memset(x, 0, sizeof(x));
+    memset(&ctx, 0, sizeof(ctx));
+    return 0;
+}
@@ -1,71 +1,1110 @@
 #include "pwman.h"
 
-int save_vault(const char *filepath, Vault *vault, const char *master_password) {
-    VaultFileLayout layout;
-    uint8_t key[MASTER_KEY_LEN];
-    struct chacha20_context ctx;
+#define INDEX_SLOTS_PER_BLOCK (64 / sizeof(VaultIndexSlot))
+#define JOURNAL_CHUNK 16
+// Champs de l'en-tête chiffrés avec le bloc 0 du keystream (de count à la fin)
+#define HEADER_SEALED_LEN (sizeof(VaultFileHeader) - __builtin_offsetof(VaultFileHeader, count))
+#define HEADER_TAG_OFFSET __builtin_offsetof(VaultFileHeader, tag)
+#define AUTH_CHUNK (64 * 1024)
+
+static int pread_full(int fd, void *buf, size_t len, size_t offset) {
+    uint8_t *p = buf;
+    while (len > 0) {
+        ssize_t n = pread(fd, p, len, (long)offset);
+        if (n <= 0) return -1;
+        p += n;
+        offset += n;
+        len -= n;
+    }
+    return 0;
+}
 
+// Remplit buf d'octets aléatoires (/dev/urandom)
+static int random_bytes(uint8_t *buf, size_t len) {
     int urandom_fd = open("/dev/urandom", O_RDONLY, 0);
     if (urandom_fd < 0) {
         puts("Erreur: Impossible d'ouvrir /dev/urandom.\n");
         return -1;
     }
-    if (read(urandom_fd, layout.nonce, CHACHA20_NONCE_LEN) != CHACHA20_NONCE_LEN) {
-        puts("Erreur: Impossible de lire le nonce depuis /dev/urandom.\n");
-        close(urandom_fd);
-        return -1;
-    }
+    int ret = pread_full(urandom_fd, buf, len, 0);
     close(urandom_fd);
+    if (ret != 0) {
+        puts("Erreur: Impossible de lire /dev/urandom.\n");
+    }
+    return ret;
+}
+
+// Sous-clés de vérification du mot de passe et d'authentification
+static void derive_check_keys(const uint8_t key[MASTER_KEY_LEN], uint8_t check[KEY_CHECK_LEN],
+                              uint8_t mac_key[MASTER_KEY_LEN]) {
+    derive_subkey(key, "pwman-check", check, KEY_CHECK_LEN);
+    derive_subkey(key, "pwman-mac", mac_key, MASTER_KEY_LEN);
+}
+
+// Démarre un Poly1305 dont la clé à usage unique est le début du keystream (mac_key, nonce)
+static void mac_start(struct poly1305_context *mac, const uint8_t mac_key[MASTER_KEY_LEN],
+                      const uint8_t nonce[CHACHA20_NONCE_LEN]) {
+    uint8_t one_time_key[POLY1305_KEY_LEN];
+    struct chacha20_context ctx;
+
+    memset(one_time_key, 0, POLY1305_KEY_LEN);
+    chacha20_init_context(&ctx, mac_key, nonce, 0);
+    chacha20_xor(&ctx, one_time_key, POLY1305_KEY_LEN);
+    poly1305_init(mac, one_time_key);
+
+    memset(&ctx, 0, sizeof(ctx));
+    memset(one_time_key, 0, POLY1305_KEY_LEN);
+}
+
+// Absorbe l'en-tête tel qu'écrit (champs scellés chiffrés), sans le tag
+static void mac_header(struct poly1305_context *mac, const uint8_t *header) {
+    poly1305_update(mac, header, HEADER_TAG_OFFSET);
+    poly1305_update(mac, header + __builtin_offsetof(VaultFileHeader, count), HEADER_SEALED_LEN);
+}
+
+// Tag d'un enregistrement du journal (entrée déjà chiffrée)
+static void journal_mac(const uint8_t mac_key[MASTER_KEY_LEN], const JournalRecord *record,
+                        uint8_t tag[POLY1305_TAG_LEN]) {
+    struct poly1305_context mac;
+
+    mac_start(&mac, mac_key, record->nonce);
+    poly1305_update(&mac, (const uint8_t *)&record->entry, sizeof(PwEntry));
+    poly1305_finish(&mac, tag);
+}
+
+// Position dans le keystream d'un octet du snapshot, d'après sa position dans le fichier
+static size_t stream_offset(size_t file_offset) {
+    return file_offset - sizeof(VaultFileHeader) + VAULT_ENTRIES_OFFSET;
+}
+
+// Offsets dans le fichier de la table des enregistrements, de l'index et du pool
+static size_t table_file_offset(int record) {
+    return sizeof(VaultFileHeader) + (size_t)record * sizeof(uint32_t);
+}
+
+static size_t index_file_offset(int count) {
+    return table_file_offset(count);
+}
+
+static size_t index_stream_offset(int count) {
+    return stream_offset(index_file_offset(count));
+}
+
+static size_t pool_file_offset(int count, int index_capacity) {
+    return index_file_offset(count) + (size_t)index_capacity * sizeof(VaultIndexSlot);
+}
+
+static uint64_t name_hash(const uint8_t index_key[INDEX_KEY_LEN], const char *name) {
+    size_t len = 0;
+    while (len < MAX_NAME_LEN && name[len]) len++;
+    return siphash24(index_key, name, len);
+}
+
+// Insère sans vérifier les doublons (la table n'est jamais pleine: charge <= 1/2)
+static void index_insert(VaultIndexSlot *slots, int capacity, uint64_t hash, int record) {
+    uint32_t mask = (uint32_t)capacity - 1;
+    uint32_t pos = (uint32_t)hash & mask;
+
+    while (slots[pos].record != 0) {
+        pos = (pos + 1) & mask;
+    }
+    slots[pos].tag = (uint32_t)(hash >> 32);
+    slots[pos].record = (uint32_t)record + 1;
+}
+
+// Taille du snapshot (en-tête, table, index, pool stocké), où commence le journal
+static size_t vault_file_size(int count, int index_capacity, uint32_t pool_size) {
+    return pool_file_offset(count, index_capacity) + pool_size;
+}
+
+// Position dans le fichier du i-ème enregistrement du journal
+static size_t journal_offset(const VaultHandle *handle, int i) {
+    return vault_file_size(handle->count, handle->index_capacity, handle->pool_size) + (size_t)i * sizeof(JournalRecord);
+}
+
+static uint32_t pool_blocks(uint32_t pool_len) {
+    return (pool_len + LZ_BLOCK_SIZE - 1) / LZ_BLOCK_SIZE;
+}
+
+/**
+ * Compresse le pool bloc par bloc: la table des (blocs + 1) débuts de bloc,
+ * puis les blocs compressés. Retourne NULL (pool écrit tel quel) si la
+ * compression ne fait pas gagner de place ou si la mémoire manque.
+ */
+static uint8_t *pool_compress(const uint8_t *pool, uint32_t pool_len, uint32_t *stored_len) {
+    uint32_t blocks = pool_blocks(pool_len);
+    size_t table_len = ((size_t)blocks + 1) * sizeof(uint32_t);
+    if (table_len >= pool_len) return NULL;
+
+    size_t cap = pool_len - table_len;
+    uint8_t *out = malloc(table_len + cap);
+    if (out == NULL) return NULL;
+
+    uint32_t *table = (uint32_t *)out;
+    size_t used = 0;
+    for (uint32_t b = 0; b < blocks; b++) {
+        size_t start = (size_t)b * LZ_BLOCK_SIZE;
+        size_t len = (pool_len - start < LZ_BLOCK_SIZE) ? pool_len - start : LZ_BLOCK_SIZE;
+        size_t n = lz_compress(pool + start, len, out + table_len + used, cap - used);
+        if (n == 0) {
+            memset(out, 0, table_len + used);
+            free(out);
+            return NULL;
+        }
+        table[b] = (uint32_t)used;
+        used += n;
+    }
+    table[blocks] = (uint32_t)used;
+    *stored_len = (uint32_t)(table_len + used);
+    return out;
+}
+
+/*
+ * Encodage des entrées dans le pool: chaque champ est écrit sur sa longueur
+ * réelle, précédée d'un varint, au lieu de ses 64 octets fixes.
+ */
+static const struct {
+    size_t offset;
+    size_t size;
+} entry_fields[] = {
+    { __builtin_offsetof(PwEntry, name), MAX_NAME_LEN },
+    { __builtin_offsetof(PwEntry, platform), MAX_PLATFORM_LEN },
+    { __builtin_offsetof(PwEntry, user), MAX_USER_LEN },
+    { __builtin_offsetof(PwEntry, password), MAX_PASSWORD_LEN },
+};
+
+#define ENTRY_FIELDS (sizeof(entry_fields) / sizeof(entry_fields[0]))
+#define FIELD(entry, f) ((char *)(entry) + entry_fields[f].offset)
+
+// Longueur d'un champ, toujours inférieure à sa taille (place du '\0')
+static size_t field_len(const char *field, size_t size) {
+    size_t len = 0;
+    while (len < size - 1 && field[len]) len++;
+    return len;
+}
+
+static size_t varint_len(size_t value) {
+    size_t n = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        n++;
+    }
+    return n;
+}
+
+static uint8_t *varint_put(uint8_t *p, size_t value) {
+    while (value >= 0x80) {
+        *p++ = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    *p++ = (uint8_t)value;
+    return p;
+}
+
+// Retourne la position après le varint, ou NULL s'il déborde de [p, end)
+static const uint8_t *varint_get(const uint8_t *p, const uint8_t *end, size_t *value) {
+    size_t v = 0;
+    for (int shift = 0; p < end && shift < 35; shift += 7) {
+        uint8_t byte = *p++;
+        v |= (size_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = v;
+            return p;
+        }
+    }
+    return NULL;
+}
+
+static size_t entry_packed_len(const PwEntry *entry) {
+    size_t len = 0;
+    for (size_t f = 0; f < ENTRY_FIELDS; f++) {
+        size_t n = field_len(FIELD(entry, f), entry_fields[f].size);
+        len += varint_len(n) + n;
+    }
+    return len;
+}
+
+static uint8_t *entry_pack(const PwEntry *entry, uint8_t *p) {
+    for (size_t f = 0; f < ENTRY_FIELDS; f++) {
+        size_t n = field_len(FIELD(entry, f), entry_fields[f].size);
+        p = varint_put(p, n);
+        memcpy(p, FIELD(entry, f), n);
+        p += n;
+    }
+    return p;
+}
+
+// Décode exactement [p, end); un champ trop long pour PwEntry signale une corruption
+static int entry_unpack(const uint8_t *p, const uint8_t *end, PwEntry *out) {
+    memset(out, 0, sizeof(PwEntry));
+    for (size_t f = 0; f < ENTRY_FIELDS; f++) {
+        size_t n;
+        p = varint_get(p, end, &n);
+        if (p == NULL || n >= entry_fields[f].size || n > (size_t)(end - p)) return -1;
+        memcpy(FIELD(out, f), p, n);
+        p += n;
+    }
+    return (p == end) ? 0 : -1;
+}
+
+// Reconstruit l'index avec une nouvelle capacité (croissance ou nouvelle clé)
+static int index_rebuild(Vault *vault, int capacity) {
+    VaultIndexSlot *slots = malloc((size_t)capacity * sizeof(VaultIndexSlot));
+    if (slots == NULL) return -1;
+    memset(slots, 0, (size_t)capacity * sizeof(VaultIndexSlot));
+
+    for (int i = 0; i < vault->count; i++) {
+        index_insert(slots, capacity, name_hash(vault->index_key, vault->entries[i].name), i);
+    }
+
+    free(vault->index);
+    vault->index = slots;
+    vault->index_capacity = capacity;
+    return 0;
+}
+
+void vault_init(Vault *vault) {
+    vault->count = 0;
+    vault->capacity = 0;
+    vault->entries = NULL;
+    vault->index = NULL;
+    vault->index_capacity = 0;
+    memset(vault->index_key, 0, INDEX_KEY_LEN);
+    memset(vault->key, 0, MASTER_KEY_LEN);
+    memset(vault->salt, 0, KDF_SALT_LEN);
+    vault->kdf.m_cost = 0;
+    vault->kdf.t_cost = 0;
+}
 
-    normalize_key(master_password, key);
-    memcpy(layout.encrypted_vault, vault, sizeof(Vault));
-    chacha20_init_context(&ctx, key, layout.nonce, 0);
-    chacha20_xor(&ctx, layout.encrypted_vault, sizeof(Vault));
+static int kdf_params_valid(const KdfParams *params) {
+    return params->m_cost >= KDF_MIN_M_COST && params->m_cost <= KDF_MAX_M_COST
+           && params->t_cost >= 1 && params->t_cost <= KDF_MAX_T_COST;
+}
+
+/**
+ * (Re)définit le mot de passe du coffre: nouveau sel aléatoire et clé maître
+ * dérivée avec `params`. Le prochain save_vault chiffre avec cette clé.
+ */
+int vault_set_password(Vault *vault, const char *password, const KdfParams *params) {
+    if (!kdf_params_valid(params)) return -1;
+    if (random_bytes(vault->salt, KDF_SALT_LEN) != 0) return -1;
+
+    vault->kdf = *params;
+    return kdf_derive(password, vault->salt, &vault->kdf, vault->key);
+}
+
+/**
+ * Garantit la place pour au moins `capacity` entrées.
+ * La capacité double pour que les ajouts successifs restent en O(1) amorti.
+ */
+int vault_reserve(Vault *vault, int capacity) {
+    if (capacity <= vault->capacity) return 0;
+    if (capacity > VAULT_MAX_ENTRIES) return -1;
 
-    int fd = open(filepath, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    int new_capacity = vault->capacity ? vault->capacity : VAULT_INITIAL_CAPACITY;
+    while (new_capacity < capacity) new_capacity *= 2;
+    if (new_capacity > VAULT_MAX_ENTRIES) new_capacity = VAULT_MAX_ENTRIES;
+
+    PwEntry *entries = realloc(vault->entries, (size_t)new_capacity * sizeof(PwEntry));
+    if (entries == NULL) return -1;
+
+    vault->entries = entries;
+    vault->capacity = new_capacity;
+    return 0;
+}
+
+/**
+ * Réserve une nouvelle entrée en fin de coffre, y copie le nom et l'indexe.
+ * L'appelant complète les autres champs.
+ * Retourne NULL si la mémoire est épuisée ou le coffre plein.
+ */
+PwEntry *vault_append(Vault *vault, const char *name) {
+    if (vault_reserve(vault, vault->count + 1) != 0) return NULL;
+
+    if ((vault->count + 1) * 2 > vault->index_capacity) {
+        int capacity = vault->index_capacity ? vault->index_capacity * 2 : VAULT_INDEX_MIN_CAPACITY;
+        if (index_rebuild(vault, capacity) != 0) return NULL;
+    }
+
+    PwEntry *entry = &vault->entries[vault->count];
+    memset(entry, 0, sizeof(PwEntry));
+    size_t len = strlen(name);
+    if (len >= MAX_NAME_LEN) len = MAX_NAME_LEN - 1;
+    memcpy(entry->name, name, len);
+
+    index_insert(vault->index, vault->index_capacity, name_hash(vault->index_key, entry->name), vault->count);
+    vault->count++;
+    return entry;
+}
+
+/**
+ * Retourne l'index de l'entrée `name`, ou -1 si elle n'existe pas.
+ */
+int vault_lookup(const Vault *vault, const char *name) {
+    if (vault->index_capacity == 0) return -1;
+
+    uint64_t hash = name_hash(vault->index_key, name);
+    uint32_t mask = (uint32_t)vault->index_capacity - 1;
+    uint32_t tag = (uint32_t)(hash >> 32);
+
+    for (uint32_t pos = (uint32_t)hash & mask; vault->index[pos].record != 0; pos = (pos + 1) & mask) {
+        int record = (int)vault->index[pos].record - 1;
+        if (vault->index[pos].tag == tag && strncmp(vault->entries[record].name, name, MAX_NAME_LEN) == 0) {
+            return record;
+        }
+    }
+    return -1;
+}
+
+// Efface les entrées en clair avant de rendre la mémoire
+void vault_free(Vault *vault) {
+    if (vault->entries != NULL) {
+        memset(vault->entries, 0, (size_t)vault->capacity * sizeof(PwEntry));
+        free(vault->entries);
+    }
+    if (vault->index != NULL) {
+        memset(vault->index, 0, (size_t)vault->index_capacity * sizeof(VaultIndexSlot));
+        free(vault->index);
+    }
+    vault_init(vault);
+}
+
+/**
+ * Écrit le snapshot (en-tête déjà scellé, table, index, pool stocké de
+ * pool_size octets) dans une
+ * projection partagée du fichier: le clair est copié une seule fois à sa place
+ * finale puis chiffré sur place, et le tag Poly1305 est calculé sur le chiffré.
+ */
+static int snapshot_write(const char *filepath, const VaultFileHeader *header, struct chacha20_context *ctx,
+                          const uint8_t mac_key[MASTER_KEY_LEN],
+                          const Vault *vault, const uint32_t *table, const uint8_t *stored, uint32_t pool_size) {
+    int fd = open(filepath, O_RDWR | O_CREAT | O_TRUNC, 0600);
     if (fd < 0) {
         puts("Erreur: Impossible de créer ou d'ouvrir le fichier de coffre-fort.\n");
         return -1;
     }
-    
-    ssize_t bytes_written = write(fd, &layout, sizeof(VaultFileLayout));
+
+    size_t len = vault_file_size(vault->count, vault->index_capacity, pool_size);
+    uint8_t *map = MAP_FAILED;
+    if (ftruncate(fd, (long)len) == 0) {
+        map = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
     close(fd);
 
-    if (bytes_written != sizeof(VaultFileLayout)) {
+    int ret = -1;
+    if (map != MAP_FAILED) {
+        memcpy(map, header, sizeof(VaultFileHeader));
+        memcpy(map + table_file_offset(0), table, (size_t)vault->count * sizeof(uint32_t));
+        memcpy(map + index_file_offset(vault->count), vault->index,
+               (size_t)vault->index_capacity * sizeof(VaultIndexSlot));
+        memcpy(map + pool_file_offset(vault->count, vault->index_capacity), stored, pool_size);
+
+        // Table, index et pool se suivent dans le keystream, comme dans le fichier
+        STATS_BEGIN(t_encrypt);
+        chacha20_seek(ctx, VAULT_ENTRIES_OFFSET);
+        chacha20_xor_parallel(ctx, map + sizeof(VaultFileHeader), len - sizeof(VaultFileHeader));
+        STATS_END(t_encrypt, "encrypt");
+
+        // Le tag couvre l'en-tête et le snapshot chiffrés (encrypt-then-MAC)
+        STATS_BEGIN(t_mac);
+        struct poly1305_context mac;
+        mac_start(&mac, mac_key, header->nonce);
+        mac_header(&mac, map);
+        poly1305_update(&mac, map + sizeof(VaultFileHeader), len - sizeof(VaultFileHeader));
+        poly1305_finish(&mac, map + HEADER_TAG_OFFSET);
+        STATS_END(t_mac, "mac");
+
+        STATS_BEGIN(t_sync);
+        ret = msync(map, len, MS_SYNC);
+        STATS_END(t_sync, "sync");
+        munmap(map, len);
+    }
+
+    if (ret != 0) {
         puts("Erreur lors de l'écriture dans le fichier de coffre-fort.\n");
+    }
+    return ret;
+}
+
+/**
+ * Chiffre et écrit le coffre avec la clé déjà dérivée (load_vault ou
+ * vault_set_password): la KDF n'est pas rejouée. L'index est maintenu en
+ * mémoire par vault_append et simplement chiffré ici; il n'est reconstruit
+ * que si la clé d'index a changé (coffre neuf ou nouveau mot de passe).
+ * Les entrées sont encodées dans le pool (voir VaultFileHeader), compressé
+ * avant chiffrement quand c'est plus court: seuls les octets utiles sont
+ * chiffrés et écrits.
+ */
+int save_vault(const char *filepath, Vault *vault) {
+    STATS_BEGIN(t_save);
+    VaultFileHeader header;
+    uint8_t *key = vault->key;
+    uint8_t index_key[INDEX_KEY_LEN];
+    uint8_t mac_key[MASTER_KEY_LEN];
+    struct chacha20_context ctx;
+
+    if (!kdf_params_valid(&vault->kdf)) return -1;
+
+    derive_subkey(key, "pwman-index", index_key, INDEX_KEY_LEN);
+    if (vault->index == NULL || memcmp(index_key, vault->index_key, INDEX_KEY_LEN) != 0) {
+        memcpy(vault->index_key, index_key, INDEX_KEY_LEN);
+        int capacity = vault->index_capacity ? vault->index_capacity : VAULT_INDEX_MIN_CAPACITY;
+        if (index_rebuild(vault, capacity) != 0) {
+            return -1;
+        }
+    }
+    memset(index_key, 0, sizeof(index_key));
+
+    memcpy(header.magic, VAULT_MAGIC, 4);
+    header.version = VAULT_VERSION;
+    header.flags = 0;
+    memcpy(header.salt, vault->salt, KDF_SALT_LEN);
+    header.kdf = vault->kdf;
+    memset(header.tag, 0, POLY1305_TAG_LEN);
+    header.count = (uint32_t)vault->count;
+    header.index_capacity = (uint32_t)vault->index_capacity;
+    header.pool_len = 0;
+    for (int i = 0; i < vault->count; i++) {
+        header.pool_len += (uint32_t)entry_packed_len(&vault->entries[i]);
+    }
+
+    // Table et pool encodés sur le heap, puis le pool est compressé si c'est plus court
+    STATS_BEGIN(t_encode);
+    uint32_t pool_len = header.pool_len;
+    uint8_t *pool = malloc(pool_len ? pool_len : 1);
+    uint32_t *table = malloc(vault->count ? (size_t)vault->count * sizeof(uint32_t) : 1);
+    if (pool == NULL || table == NULL) {
+        free(pool);
+        free(table);
+        return -1;
+    }
+    uint8_t *p = pool;
+    for (int i = 0; i < vault->count; i++) {
+        table[i] = (uint32_t)(p - pool);
+        p = entry_pack(&vault->entries[i], p);
+    }
+    STATS_END(t_encode, "encode");
+
+    STATS_BEGIN(t_compress);
+    header.pool_size = pool_len;
+    uint8_t *packed = pool_compress(pool, pool_len, &header.pool_size);
+    STATS_END(t_compress, "compress");
+    if (packed != NULL) {
+        header.flags |= VAULT_FLAG_LZ;
+    }
+    uint32_t pool_size = header.pool_size;
+
+    derive_check_keys(key, header.key_check, mac_key);
+    int ret = random_bytes(header.nonce, CHACHA20_NONCE_LEN);
+    if (ret == 0) {
+        chacha20_init_context(&ctx, key, header.nonce, 0);
+        chacha20_xor(&ctx, (uint8_t *)&header.count, HEADER_SEALED_LEN);
+        ret = snapshot_write(filepath, &header, &ctx, mac_key, vault, table, packed ? packed : pool, pool_size);
+        memset(&ctx, 0, sizeof(ctx));
+    }
+    memset(mac_key, 0, sizeof(mac_key));
+
+    memset(pool, 0, pool_len);
+    free(pool);
+    free(table);
+    if (packed != NULL) {
+        memset(packed, 0, pool_size);
+        free(packed);
+    }
+    STATS_END(t_save, "save_vault");
+    return ret;
+}
+
+/**
+ * Vérifie le tag du snapshot (sur l'en-tête brut, champs scellés chiffrés)
+ * puis celui de chaque enregistrement complet du journal. Le fichier est lu
+ * par morceaux de AUTH_CHUNK octets, sans rien déchiffrer.
+ */
+static int vault_authenticate(VaultHandle *handle, const VaultFileHeader *raw_header) {
+    struct poly1305_context mac;
+    uint8_t tag[POLY1305_TAG_LEN];
+    size_t end = journal_offset(handle, 0);
+    int ret = 0;
+
+    uint8_t *chunk = malloc(AUTH_CHUNK);
+    if (chunk == NULL) return -1;
+
+    mac_start(&mac, handle->mac_key, handle->nonce);
+    mac_header(&mac, (const uint8_t *)raw_header);
+    for (size_t offset = sizeof(VaultFileHeader); offset < end && ret == 0; offset += AUTH_CHUNK) {
+        size_t n = (end - offset < AUTH_CHUNK) ? end - offset : AUTH_CHUNK;
+        ret = pread_full(handle->fd, chunk, n, offset);
+        if (ret == 0) poly1305_update(&mac, chunk, n);
+    }
+    poly1305_finish(&mac, tag);
+    if (ret == 0) ret = poly1305_verify(tag, raw_header->tag);
+
+    JournalRecord *records = (JournalRecord *)chunk;
+    int per_chunk = (int)(AUTH_CHUNK / sizeof(JournalRecord));
+    for (int first = 0; first < handle->journal_count && ret == 0; first += per_chunk) {
+        int n = handle->journal_count - first;
+        if (n > per_chunk) n = per_chunk;
+
+        ret = pread_full(handle->fd, records, (size_t)n * sizeof(JournalRecord), journal_offset(handle, first));
+        for (int i = 0; i < n && ret == 0; i++) {
+            journal_mac(handle->mac_key, &records[i], tag);
+            ret = poly1305_verify(tag, records[i].tag);
+        }
+    }
+
+    free(chunk);
+    return ret;
+}
+
+/**
+ * Ouvre un coffre pour des lectures ciblées: seul l'en-tête est déchiffré.
+ * La clé est dérivée du mot de passe avec le sel et les coûts de l'en-tête,
+ * bornés pour qu'un fichier altéré ne puisse pas exiger une mémoire démesurée.
+ * Avec master_password NULL, la clé est lue dans le trousseau de session
+ * (keycache.c); sinon la clé dérivée y est mise en cache une fois le fichier
+ * authentifié.
+ * Un mauvais mot de passe est rejeté par key_check, juste après la KDF.
+ * Ensuite le tag Poly1305 du snapshot et ceux du journal sont vérifiés
+ * avant toute lecture: une altération est détectée même hors des entrées lues.
+ * Un enregistrement de journal tronqué (écriture interrompue) est ignoré;
+ * le prochain ajout l'écrase.
+ */
+int vault_open(const char *filepath, VaultHandle *handle, const char *master_password) {
+    VaultFileHeader raw_header, header;
+    uint8_t check[KEY_CHECK_LEN];
+    struct chacha20_context ctx;
+
+    handle->fd = open(filepath, O_RDONLY, 0);
+    if (handle->fd < 0) {
+        return -1;
+    }
+
+    long file_size = lseek(handle->fd, 0, SEEK_END);
+    if (pread(handle->fd, &raw_header, sizeof(VaultFileHeader), 0) != sizeof(VaultFileHeader)
+        || strncmp((const char *)raw_header.magic, VAULT_MAGIC, 4) != 0
+        || raw_header.version != VAULT_VERSION || (raw_header.flags & ~VAULT_FLAG_LZ) != 0) {
+        puts("Erreur: Fichier de coffre-fort corrompu ou de taille incorrecte.\n");
+        close(handle->fd);
+        return -1;
+    }
+    header = raw_header;
+
+    if (!kdf_params_valid(&header.kdf)) {
+        puts("Erreur: Paramètres de dérivation de clé invalides.\n");
+        close(handle->fd);
         return -1;
     }
+    memcpy(handle->salt, header.salt, KDF_SALT_LEN);
+    handle->kdf = header.kdf;
+    STATS_BEGIN(t_key);
+    if (master_password == NULL) {
+        if (keycache_lookup(handle->salt, handle->key) != 0) {
+            puts("Error: The cached key has expired.\n");
+            vault_close(handle);
+            return -1;
+        }
+        STATS_END(t_key, "keycache");
+    } else {
+        if (kdf_derive(master_password, handle->salt, &handle->kdf, handle->key) != 0) {
+            puts("Erreur: Mémoire insuffisante pour dériver la clé.\n");
+            vault_close(handle);
+            return -1;
+        }
+        STATS_END(t_key, "kdf");
+    }
 
+    derive_check_keys(handle->key, check, handle->mac_key);
+    int key_ok = (poly1305_verify(check, header.key_check) == 0);
+    memset(check, 0, sizeof(check));
+    if (!key_ok) {
+        puts("Error: Wrong master password.\n");
+        if (master_password == NULL) keycache_forget(handle->salt);
+        vault_close(handle);
+        return -1;
+    }
+
+    memcpy(handle->nonce, header.nonce, CHACHA20_NONCE_LEN);
+    chacha20_init_context(&ctx, handle->key, handle->nonce, 0);
+    chacha20_xor(&ctx, (uint8_t *)&header.count, HEADER_SEALED_LEN);
+    memset(&ctx, 0, sizeof(ctx));
+
+    // Une entrée encodée ne dépasse jamais sizeof(PwEntry) (4 varints d'un octet + 4 * 63);
+    // un pool compressé n'est gardé que s'il est plus court (table de blocs comprise)
+    uint32_t index_cap = header.index_capacity;
+    int pool_ok = (header.flags & VAULT_FLAG_LZ)
+                  ? header.pool_size < header.pool_len
+                    && header.pool_size > ((uint64_t)pool_blocks(header.pool_len) + 1) * sizeof(uint32_t)
+                  : header.pool_size == header.pool_len;
+    int valid = header.count <= VAULT_MAX_ENTRIES
+                && index_cap <= 4 * VAULT_MAX_ENTRIES && (index_cap & (index_cap - 1)) == 0
+                && (uint64_t)header.count * 2 <= index_cap
+                && (uint64_t)header.pool_len <= (uint64_t)header.count * sizeof(PwEntry) && pool_ok
+                && file_size >= (long)vault_file_size((int)header.count, (int)index_cap, header.pool_size)
+                && (file_size - (long)vault_file_size((int)header.count, (int)index_cap, header.pool_size))
+                   / (long)sizeof(JournalRecord) <= VAULT_MAX_ENTRIES;
+
+    if (valid) {
+        handle->count = (int)header.count;
+        handle->index_capacity = (int)index_cap;
+        handle->flags = header.flags;
+        handle->pool_len = header.pool_len;
+        handle->pool_size = header.pool_size;
+        handle->journal_count = (int)((file_size - (long)journal_offset(handle, 0)) / (long)sizeof(JournalRecord));
+        STATS_BEGIN(t_auth);
+        valid = (vault_authenticate(handle, &raw_header) == 0);
+        STATS_END(t_auth, "authenticate");
+    }
+    if (!valid) {
+        puts("Error: Vault authentication failed. The file is corrupted.\n");
+        vault_close(handle);
+        return -1;
+    }
+
+    if (master_password != NULL) keycache_store(handle->salt, handle->key);
+
+    derive_subkey(handle->key, "pwman-index", handle->index_key, INDEX_KEY_LEN);
     return 0;
 }
 
-int load_vault(const char *filepath, Vault *vault, const char *master_password) {
-    VaultFileLayout layout;
-    uint8_t key[MASTER_KEY_LEN];
+// Lit et déchiffre les octets [offset, offset + len) du snapshot (offset dans le fichier)
+static int snapshot_read(VaultHandle *handle, void *buf, size_t len, size_t offset) {
     struct chacha20_context ctx;
 
-    int fd = open(filepath, O_RDONLY, 0);
+    if (pread_full(handle->fd, buf, len, offset) != 0) return -1;
+
+    chacha20_init_context(&ctx, handle->key, handle->nonce, 0);
+    chacha20_seek(&ctx, stream_offset(offset));
+    chacha20_xor_parallel(&ctx, buf, len);
+    memset(&ctx, 0, sizeof(ctx));
+    return 0;
+}
+
+/**
+ * Lit les octets [offset, offset + len) du pool décodé. Un pool compressé est
+ * découpé en blocs indépendants: seuls les blocs qui recouvrent la tranche
+ * sont lus, déchiffrés puis décompressés.
+ */
+static int pool_read(VaultHandle *handle, uint8_t *out, size_t len, uint32_t offset) {
+    size_t base = pool_file_offset(handle->count, handle->index_capacity);
+
+    if (!(handle->flags & VAULT_FLAG_LZ)) return snapshot_read(handle, out, len, base + offset);
+    if (len == 0) return 0;
+
+    uint32_t first = offset / LZ_BLOCK_SIZE;
+    uint32_t last = (uint32_t)((offset + len - 1) / LZ_BLOCK_SIZE);
+    uint32_t n = last - first + 1;
+    size_t table_len = ((size_t)pool_blocks(handle->pool_len) + 1) * sizeof(uint32_t);
+
+    uint32_t *table = malloc(((size_t)n + 1) * sizeof(uint32_t));
+    uint8_t *block = malloc(LZ_BLOCK_SIZE);
+    uint8_t *packed = NULL;
+    size_t packed_len = 0;
+
+    int ret = (table != NULL && block != NULL) ? 0 : -1;
+    if (ret == 0) {
+        ret = snapshot_read(handle, table, ((size_t)n + 1) * sizeof(uint32_t), base + (size_t)first * sizeof(uint32_t));
+    }
+    if (ret == 0 && (table[0] > table[n] || table_len + table[n] > handle->pool_size)) ret = -1;
+    if (ret == 0) {
+        packed_len = table[n] - table[0];
+        packed = malloc(packed_len ? packed_len : 1);
+        ret = (packed != NULL) ? snapshot_read(handle, packed, packed_len, base + table_len + table[0]) : -1;
+    }
+
+    for (uint32_t i = 0; i < n && ret == 0; i++) {
+        size_t start = (size_t)(first + i) * LZ_BLOCK_SIZE;
+        size_t block_len = (handle->pool_len - start < LZ_BLOCK_SIZE) ? handle->pool_len - start : LZ_BLOCK_SIZE;
+        if (table[i] < table[0] || table[i] > table[i + 1]) {
+            ret = -1;
+            break;
+        }
+        ret = lz_decompress(packed + (table[i] - table[0]), table[i + 1] - table[i], block, block_len);
+        if (ret != 0) break;
+
+        // Part du bloc dans [offset, offset + len)
+        size_t from = (i == 0) ? offset - start : 0;
+        size_t to = (i == n - 1) ? offset + len - start : block_len;
+        memcpy(out, block + from, to - from);
+        out += to - from;
+    }
+
+    if (packed != NULL) {
+        memset(packed, 0, packed_len);
+        free(packed);
+    }
+    if (block != NULL) {
+        memset(block, 0, LZ_BLOCK_SIZE);
+        free(block);
+    }
+    free(table);
+    return ret;
+}
+
+/**
+ * Lit et déchiffre les entrées [first, first + n): leurs offsets dans la table,
+ * puis la seule tranche du pool qui les contient, sans toucher au reste du coffre.
+ */
+int vault_read_entries(VaultHandle *handle, int first, int n, PwEntry *out) {
+    if (first < 0 || n < 0 || first + n > handle->count) return -1;
+    if (n == 0) return 0;
+
+    // La fin de la dernière entrée lue est le début de la suivante, ou la fin du pool
+    int last = (first + n == handle->count);
+    uint32_t *offsets = malloc(((size_t)n + 1) * sizeof(uint32_t));
+    if (offsets == NULL) return -1;
+
+    int ret = snapshot_read(handle, offsets, ((size_t)n + !last) * sizeof(uint32_t), table_file_offset(first));
+    if (last) offsets[n] = handle->pool_len;
+
+    uint8_t *pool = NULL;
+    size_t pool_len = 0;
+    if (ret == 0 && (offsets[0] > offsets[n] || offsets[n] > handle->pool_len)) ret = -1;
+    if (ret == 0) {
+        pool_len = offsets[n] - offsets[0];
+        pool = malloc(pool_len ? pool_len : 1);
+        ret = (pool != NULL) ? 0 : -1;
+    }
+    if (ret == 0) {
+        ret = pool_read(handle, pool, pool_len, offsets[0]);
+    }
+    for (int i = 0; i < n && ret == 0; i++) {
+        if (offsets[i] < offsets[0] || offsets[i] > offsets[i + 1]) {
+            ret = -1;
+            break;
+        }
+        ret = entry_unpack(pool + (offsets[i] - offsets[0]), pool + (offsets[i + 1] - offsets[0]), &out[i]);
+    }
+
+    if (pool != NULL) {
+        memset(pool, 0, pool_len);
+        free(pool);
+    }
+    free(offsets);
+    return ret;
+}
+
+// Déchiffre (ou chiffre) les octets [offset, offset + len) de l'entrée d'un enregistrement du journal
+static void journal_decrypt(const uint8_t key[MASTER_KEY_LEN], JournalRecord *record, size_t offset, size_t len) {
+    struct chacha20_context ctx;
+
+    chacha20_init_context(&ctx, key, record->nonce, 0);
+    chacha20_seek(&ctx, offset);
+    chacha20_xor(&ctx, (uint8_t *)&record->entry + offset, len);
+    memset(&ctx, 0, sizeof(ctx));
+}
+
+/**
+ * Cherche `name` dans le journal, du plus récent au plus ancien: seul le champ
+ * name (un bloc) de chaque enregistrement est déchiffré avant comparaison.
+ * Retourne la position dans le journal, ou -1.
+ */
+static int journal_find(VaultHandle *handle, const char *name, PwEntry *out) {
+    JournalRecord chunk[JOURNAL_CHUNK];
+    int found = -1;
+
+    for (int end = handle->journal_count; end > 0 && found < 0; end -= JOURNAL_CHUNK) {
+        int first = (end > JOURNAL_CHUNK) ? end - JOURNAL_CHUNK : 0;
+        int n = end - first;
+
+        if (pread_full(handle->fd, chunk, (size_t)n * sizeof(JournalRecord), journal_offset(handle, first)) != 0) {
+            break;
+        }
+
+        for (int i = n - 1; i >= 0; i--) {
+            journal_decrypt(handle->key, &chunk[i], 0, MAX_NAME_LEN);
+            if (strncmp(chunk[i].entry.name, name, MAX_NAME_LEN) == 0) {
+                journal_decrypt(handle->key, &chunk[i], MAX_NAME_LEN, sizeof(PwEntry) - MAX_NAME_LEN);
+                memcpy(out, &chunk[i].entry, sizeof(PwEntry));
+                found = first + i;
+                break;
+            }
+        }
+    }
+
+    memset(chunk, 0, sizeof(chunk));
+    return found;
+}
+
+/**
+ * Rejoue le journal sur le coffre chargé: une entrée déjà présente est
+ * remplacée, sinon elle est ajoutée (et indexée).
+ */
+static int journal_replay(VaultHandle *handle, Vault *vault) {
+    JournalRecord chunk[JOURNAL_CHUNK];
+    int ret = 0;
+
+    for (int first = 0; first < handle->journal_count && ret == 0; first += JOURNAL_CHUNK) {
+        int n = handle->journal_count - first;
+        if (n > JOURNAL_CHUNK) n = JOURNAL_CHUNK;
+
+        if (pread_full(handle->fd, chunk, (size_t)n * sizeof(JournalRecord), journal_offset(handle, first)) != 0) {
+            ret = -1;
+            break;
+        }
+
+        for (int i = 0; i < n; i++) {
+            journal_decrypt(handle->key, &chunk[i], 0, sizeof(PwEntry));
+            chunk[i].entry.name[MAX_NAME_LEN - 1] = '\0';
+
+            int record = vault_lookup(vault, chunk[i].entry.name);
+            PwEntry *entry = (record >= 0) ? &vault->entries[record] : vault_append(vault, chunk[i].entry.name);
+            if (entry == NULL) {
+                ret = -1;
+                break;
+            }
+            memcpy(entry, &chunk[i].entry, sizeof(PwEntry));
+        }
+    }
+
+    memset(chunk, 0, sizeof(chunk));
+    return ret;
+}
+
+/**
+ * Lit et déchiffre les enregistrements [first, first + n) du journal dans out,
+ * par paquets de JOURNAL_CHUNK (mémoire bornée quelle que soit la taille).
+ */
+int vault_read_journal(VaultHandle *handle, int first, int n, PwEntry *out) {
+    JournalRecord chunk[JOURNAL_CHUNK];
+    int ret = 0;
+
+    if (first < 0 || n < 0 || first + n > handle->journal_count) return -1;
+
+    for (int done = 0; done < n && ret == 0; done += JOURNAL_CHUNK) {
+        int k = n - done;
+        if (k > JOURNAL_CHUNK) k = JOURNAL_CHUNK;
+
+        if (pread_full(handle->fd, chunk, (size_t)k * sizeof(JournalRecord), journal_offset(handle, first + done)) != 0) {
+            ret = -1;
+            break;
+        }
+        for (int i = 0; i < k; i++) {
+            journal_decrypt(handle->key, &chunk[i], 0, sizeof(PwEntry));
+            memcpy(&out[done + i], &chunk[i].entry, sizeof(PwEntry));
+        }
+    }
+
+    memset(chunk, 0, sizeof(chunk));
+    return ret;
+}
+
+/**
+ * Ajoute une entrée au journal sans réécrire le snapshot: un seul
+ * enregistrement est chiffré (nonce propre) et écrit, en O(1).
+ * L'écriture se fait à la position attendue, ce qui recouvre un éventuel
+ * enregistrement tronqué par une écriture interrompue; elle est refusée si
+ * le fichier a changé depuis vault_open.
+ */
+int vault_journal_append(const char *filepath, VaultHandle *handle, const PwEntry *entry) {
+    JournalRecord record;
+
+    if (random_bytes(record.nonce, CHACHA20_NONCE_LEN) != 0) {
+        return -1;
+    }
+
+    // Un autre écrivain (add, compact) a modifié le fichier depuis l'ouverture:
+    // écrire à la position attendue l'écraserait. Seul un enregistrement
+    // tronqué (moins d'un JournalRecord) peut dépasser la fin prévue.
+    long end = (long)journal_offset(handle, handle->journal_count);
+    long file_size = lseek(handle->fd, 0, SEEK_END);
+    if (file_size < end || file_size >= end + (long)sizeof(JournalRecord)) {
+        puts("Error: The vault file changed on disk since it was opened.\n");
+        return -1;
+    }
+
+    memcpy(&record.entry, entry, sizeof(PwEntry));
+    journal_decrypt(handle->key, &record, 0, sizeof(PwEntry));
+    journal_mac(handle->mac_key, &record, record.tag);
+
+    int fd = open(filepath, O_WRONLY, 0);
     if (fd < 0) {
+        puts("Erreur: Impossible d'ouvrir le fichier de coffre-fort en écriture.\n");
         return -1;
     }
-    ssize_t bytes_read = read(fd, &layout, sizeof(VaultFileLayout));
+    ssize_t written = pwrite(fd, &record, sizeof(JournalRecord), (long)journal_offset(handle, handle->journal_count));
     close(fd);
 
-    if (bytes_read != sizeof(VaultFileLayout)) {
-        puts("Erreur: Fichier de coffre-fort corrompu ou de taille incorrecte.\n");
+    if (written != sizeof(JournalRecord)) {
+        puts("Erreur lors de l'écriture dans le fichier de coffre-fort.\n");
         return -1;
     }
 
-    normalize_key(master_password, key);
-    chacha20_init_context(&ctx, key, layout.nonce, 0);
-    chacha20_xor(&ctx, layout.encrypted_vault, sizeof(Vault));
-    memcpy(vault, layout.encrypted_vault, sizeof(Vault));
-    
-    // Validate vault data to detect wrong password/corrupted data
-    if (vault->count < 0 || vault->count > MAX_ENTRIES) {
-        puts("Error: Invalid vault data. Wrong password or corrupted file.\n");
+    handle->journal_count++;
+    return 0;
+}
+
+/**
+ * Cherche une entrée par nom via l'index chiffré du fichier.
+ * Les cases sont lues par bloc de keystream (8 cases), puis seul
+ * l'enregistrement candidat est lu et déchiffré: O(1) en moyenne.
+ * Le journal, plus récent, est consulté d'abord.
+ * Retourne l'index de l'entrée (count + position pour le journal), ou -1 si absente.
+ */
+int vault_find_entry(VaultHandle *handle, const char *name, PwEntry *out) {
+    VaultIndexSlot group[INDEX_SLOTS_PER_BLOCK];
+    struct chacha20_context ctx;
+    int found = -1;
+
+    memset(out, 0, sizeof(PwEntry));
+
+    int journal_pos = journal_find(handle, name, out);
+    if (journal_pos >= 0) return handle->count + journal_pos;
+
+    if (handle->index_capacity == 0) return -1;
+
+    uint64_t hash = name_hash(handle->index_key, name);
+    uint32_t mask = (uint32_t)handle->index_capacity - 1;
+    uint32_t tag = (uint32_t)(hash >> 32);
+    uint32_t pos = (uint32_t)hash & mask;
+    uint32_t loaded_group = (uint32_t)-1;
+    uint32_t group_len = ((uint32_t)handle->index_capacity < INDEX_SLOTS_PER_BLOCK)
+                         ? (uint32_t)handle->index_capacity : INDEX_SLOTS_PER_BLOCK;
+
+    chacha20_init_context(&ctx, handle->key, handle->nonce, 0);
+
+    for (int probes = 0; found < 0 && probes < handle->index_capacity; probes++) {
+        uint32_t g = pos / INDEX_SLOTS_PER_BLOCK;
+
+        if (g != loaded_group) {
+            size_t slot_offset = (size_t)g * INDEX_SLOTS_PER_BLOCK * sizeof(VaultIndexSlot);
+            if (pread_full(handle->fd, group, group_len * sizeof(VaultIndexSlot),
+                           index_file_offset(handle->count) + slot_offset) != 0) {
+                break;
+            }
+            chacha20_seek(&ctx, index_stream_offset(handle->count) + slot_offset);
+            chacha20_xor(&ctx, (uint8_t *)group, group_len * sizeof(VaultIndexSlot));
+            loaded_group = g;
+        }
+
+        VaultIndexSlot *slot = &group[pos % INDEX_SLOTS_PER_BLOCK];
+        if (slot->record == 0 || slot->record > (uint32_t)handle->count) {
+            break;
+        }
+        if (slot->tag == tag && vault_read_entries(handle, (int)slot->record - 1, 1, out) == 0
+            && strncmp(out->name, name, MAX_NAME_LEN) == 0) {
+            found = (int)slot->record - 1;
+        }
+        pos = (pos + 1) & mask;
+    }
+
+    memset(group, 0, sizeof(group));
+    memset(&ctx, 0, sizeof(ctx));
+    if (found < 0) {
+        memset(out, 0, sizeof(PwEntry));
+    }
+    return found;
+}
+
+void vault_close(VaultHandle *handle) {
+    if (handle->fd >= 0) {
+        close(handle->fd);
+    }
+    memset(handle, 0, sizeof(VaultHandle));
+    handle->fd = -1;
+}
+
+// Lit le sel en clair de l'en-tête, sans dériver de clé
+static int read_header_salt(const char *filepath, uint8_t salt[KDF_SALT_LEN]) {
+    VaultFileHeader header;
+
+    int fd = open(filepath, O_RDONLY, 0);
+    if (fd < 0) return -1;
+
+    int ret = (pread(fd, &header, sizeof(VaultFileHeader), 0) == sizeof(VaultFileHeader)
+               && strncmp((const char *)header.magic, VAULT_MAGIC, 4) == 0
+               && header.version == VAULT_VERSION) ? 0 : -1;
+    close(fd);
+    if (ret == 0) memcpy(salt, header.salt, KDF_SALT_LEN);
+    return ret;
+}
+
+/**
+ * Indique si la clé du coffre est dans le trousseau de session, auquel cas
+ * vault_open(filepath, handle, NULL) l'ouvre sans mot de passe ni KDF.
+ */
+int vault_key_cached(const char *filepath) {
+    uint8_t salt[KDF_SALT_LEN], key[MASTER_KEY_LEN];
+
+    if (read_header_salt(filepath, salt) != 0) return 0;
+
+    int cached = (keycache_lookup(salt, key) == 0);
+    memset(key, 0, sizeof(key));
+    return cached;
+}
+
+// Retire la clé du coffre du trousseau; 0 si elle y était
+int vault_forget_key(const char *filepath) {
+    uint8_t salt[KDF_SALT_LEN];
+
+    if (read_header_salt(filepath, salt) != 0) return -1;
+    return keycache_forget(salt);
+}
+
+// Garde la clé dérivée à l'ouverture pour le prochain save_vault
+static void vault_take_key(Vault *vault, const VaultHandle *handle) {
+    memcpy(vault->key, handle->key, MASTER_KEY_LEN);
+    memcpy(vault->salt, handle->salt, KDF_SALT_LEN);
+    vault->kdf = handle->kdf;
+}
+
+/**
+ * Charge et déchiffre dans `vault` le coffre d'un handle ouvert par vault_open
+ * (à libérer avec vault_free); le handle reste ouvert pour des ajouts au journal.
+ * Seules les `count` entrées présentes sont lues et déchiffrées, puis le
+ * journal est rejoué par-dessus.
+ */
+int vault_load_entries(VaultHandle *handle, Vault *vault) {
+    vault_init(vault);
+
+    size_t index_len = (size_t)handle->index_capacity * sizeof(VaultIndexSlot);
+    int ret = vault_reserve(vault, handle->count);
+    if (ret == 0) {
+        STATS_BEGIN(t_entries);
+        ret = vault_read_entries(handle, 0, handle->count, vault->entries);
+        STATS_END(t_entries, "decrypt_entries");
+    }
+    if (ret == 0) {
+        vault->count = handle->count;
+        vault->index = malloc(index_len);
+        ret = (vault->index != NULL) ? 0 : -1;
+    }
+    if (ret == 0) {
+        vault->index_capacity = handle->index_capacity;
+        memcpy(vault->index_key, handle->index_key, INDEX_KEY_LEN);
+        vault_take_key(vault, handle);
+        STATS_BEGIN(t_index);
+        ret = snapshot_read(handle, vault->index, index_len, index_file_offset(handle->count));
+        STATS_END(t_index, "decrypt_index");
+    }
+    if (ret == 0) {
+        STATS_BEGIN(t_journal);
+        ret = journal_replay(handle, vault);
+        STATS_END(t_journal, "journal_replay");
+    }
+
+    if (ret != 0) {
+        puts("Error: Invalid vault data.\n");
+        vault_free(vault);
         return -1;
     }
-    
     return 0;
-}
\ No newline at end of file
+}
+
+/**
+ * Charge et déchiffre le coffre et son index dans `vault` (à libérer avec vault_free).
+ */
+int load_vault(const char *filepath, Vault *vault, const char *master_password) {
+    VaultHandle handle;
+
+    vault_init(vault);
+
+    STATS_BEGIN(t_load);
+    if (vault_open(filepath, &handle, master_password) != 0) {
+        return -1;
+    }
+
+    int ret = vault_load_entries(&handle, vault);
+    vault_close(&handle);
+    STATS_END(t_load, "load_vault");
+    return ret;
+}
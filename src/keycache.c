@@ -0,0 +1,81 @@
+#include "pwman.h"
+
+/*
+ * Cache de la clé maître dans le trousseau de session du noyau.
+ *
+ * La clé dérivée (jamais le mot de passe) est stockée dans une clé "user"
+ * nommée d'après le sel du coffre: un changement de mot de passe ou de
+ * paramètres KDF tire un nouveau sel, l'ancienne clé n'est donc plus
+ * jamais trouvée et expire d'elle-même. Le noyau la détruit après
+ * KEY_CACHE_TIMEOUT secondes; seul un processus qui possède le trousseau
+ * de session (le même shell et ses fils) peut la lire. Hors session
+ * (pas de pam_keyinit), le noyau se rabat sur le trousseau user-session.
+ */
+
+#define KEY_CACHE_PREFIX "pwman:"
+#define KEY_CACHE_DESC_LEN (sizeof(KEY_CACHE_PREFIX) - 1 + 2 * KDF_SALT_LEN + 1)
+
+static void keycache_description(const uint8_t salt[KDF_SALT_LEN], char desc[KEY_CACHE_DESC_LEN]) {
+    static const char hex[] = "0123456789abcdef";
+    size_t len = sizeof(KEY_CACHE_PREFIX) - 1;
+
+    memcpy(desc, KEY_CACHE_PREFIX, len);
+    for (int i = 0; i < KDF_SALT_LEN; i++) {
+        desc[len++] = hex[salt[i] >> 4];
+        desc[len++] = hex[salt[i] & 0xF];
+    }
+    desc[len] = '\0';
+}
+
+/**
+ * Cherche la clé du coffre de sel `salt` dans le trousseau.
+ * Retour: 0 et la clé dans `key`, -1 si absente ou expirée.
+ */
+int keycache_lookup(const uint8_t salt[KDF_SALT_LEN], uint8_t key[MASTER_KEY_LEN]) {
+    char desc[KEY_CACHE_DESC_LEN];
+
+    keycache_description(salt, desc);
+    int id = request_key("user", desc, NULL, 0);
+    if (id < 0) return -1;
+
+    long len = keyctl(KEYCTL_READ, (unsigned long)id, (unsigned long)key, MASTER_KEY_LEN, 0);
+    if (len != MASTER_KEY_LEN) {
+        memset(key, 0, MASTER_KEY_LEN);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Met en cache la clé dérivée et (re)lance son délai d'expiration.
+ * Un échec (trousseaux indisponibles) est sans conséquence: la clé
+ * sera simplement redérivée la prochaine fois.
+ */
+void keycache_store(const uint8_t salt[KDF_SALT_LEN], const uint8_t key[MASTER_KEY_LEN]) {
+    char desc[KEY_CACHE_DESC_LEN];
+
+    // Sans création: add_key(KEY_SPEC_SESSION_KEYRING) donnerait à un processus
+    // sans trousseau de session un trousseau anonyme, perdu à sa sortie
+    long keyring = keyctl(KEYCTL_GET_KEYRING_ID, (unsigned long)KEY_SPEC_SESSION_KEYRING, 0, 0, 0);
+    if (keyring < 0) return;
+
+    keycache_description(salt, desc);
+    int id = add_key("user", desc, key, MASTER_KEY_LEN, (int)keyring);
+    if (id >= 0) {
+        keyctl(KEYCTL_SET_TIMEOUT, (unsigned long)id, KEY_CACHE_TIMEOUT, 0, 0);
+    }
+}
+
+/**
+ * Retire la clé du trousseau.
+ * Retour: 0 si une clé était en cache, -1 sinon.
+ */
+int keycache_forget(const uint8_t salt[KDF_SALT_LEN]) {
+    char desc[KEY_CACHE_DESC_LEN];
+
+    keycache_description(salt, desc);
+    int id = request_key("user", desc, NULL, 0);
+    if (id < 0) return -1;
+
+    return (keyctl(KEYCTL_INVALIDATE, (unsigned long)id, 0, 0, 0) == 0) ? 0 : -1;
+}
@@ -0,0 +1,34 @@
+/*
+ * accept4.c - Appel système accept4()
+ * 
+ * accept4() accepte une connexion en attente sur une socket d'écoute.
+ * Utilise le syscall 288 sur Linux x86_64.
+ * 
+ * Paramètres:
+ * - sockfd: socket d'écoute
+ * - addr, addrlen: adresse du pair (NULL si inutile)
+ * - flags: SOCK_NONBLOCK / SOCK_CLOEXEC pour la nouvelle socket
+ * 
+ * Retour: descripteur de la connexion, valeur négative en cas d'erreur
+ *         (-EAGAIN si aucune connexion n'attend sur une socket non bloquante)
+ */
+
+#include "libc/libc.h"
+
+int accept4(int sockfd, void *addr, unsigned int *addrlen, int flags) {
+    long ret;
+    register long flags_reg asm("r10") = flags;
+
+    __asm__ volatile (
+        "syscall"
+        : "=a" (ret)
+        : "a"(288L),
+          "D"((long)sockfd),
+          "S"(addr),
+          "d"(addrlen),
+          "r"(flags_reg)
+        : "rcx", "r11", "memory"
+    );
+    STATS_SYSCALL(STAT_SYS_ACCEPT4, ret);
+    return (int)ret;
+}
@@ -0,0 +1,36 @@
+/*
+ * add_key.c - Appel système add_key()
+ * 
+ * add_key() crée une clé (ou remplace le contenu d'une clé de même type
+ * et description) et la lie au trousseau destination.
+ * Utilise le syscall 248 sur Linux x86_64.
+ * 
+ * Paramètres:
+ * - type: type de clé ("user")
+ * - description: nom de la clé dans le trousseau
+ * - payload, plen: contenu de la clé
+ * - keyring: trousseau destination (KEY_SPEC_SESSION_KEYRING...)
+ * 
+ * Retour: numéro de série de la clé, valeur négative en cas d'erreur
+ */
+
+#include "libc/libc.h"
+
+int add_key(const char *type, const char *description, const void *payload, size_t plen, int keyring) {
+    long ret;
+    register long plen_reg asm("r10") = (long)plen;
+    register long keyring_reg asm("r8") = keyring;
+    __asm__ volatile (
+        "syscall"
+        : "=a" (ret)
+        : "a"(248L),
+          "D"(type),
+          "S"(description),
+          "d"(payload),
+          "r"(plen_reg),
+          "r"(keyring_reg)
+        : "rcx", "r11", "memory"
+    );
+    STATS_SYSCALL(STAT_SYS_ADD_KEY, ret);
+    return (int)ret;
+}
@@ -0,0 +1,108 @@
+/*
+ * arena.c - Allocation par zone (bump pointer)
+ * 
+ * Pour les commandes courtes: arena_alloc() avance un pointeur dans une
+ * tranche, sans free() individuel. arena_reset() rend toute la zone d'un coup
+ * (les tranches sont gardées pour la suite), arena_destroy() la restitue.
+ * 
+ * Les tranches viennent de mmap(): sbrk() est réservé au heap de malloc, qui
+ * suppose un tas contigu. La mémoire rendue par arena_alloc() est à zéro, et
+ * la zone utilisée est effacée en une passe au reset et à la destruction
+ * pour que les secrets ne traînent pas.
+ * 
+ * Le descripteur de l'arène est logé au début de la première tranche.
+ */
+
+#include "libc/libc.h"
+
+#define ARENA_DEFAULT_CHUNK (64 * 1024)
+#define PAGE_ROUND(n) (((n) + 4095) & ~(size_t)4095)
+
+typedef struct arena_chunk {
+    struct arena_chunk *next;
+    size_t size;    // taille utile après l'en-tête
+    size_t used;
+} arena_chunk_t;
+
+struct arena {
+    arena_chunk_t *first;
+    arena_chunk_t *current;
+    size_t chunk_size;
+};
+
+#define CHUNK_HEADER ALIGN(sizeof(arena_chunk_t))
+#define ARENA_SELF   ALIGN(sizeof(arena_t))
+#define CHUNK_DATA(c) ((char *)(c) + CHUNK_HEADER)
+
+static arena_chunk_t *chunk_new(size_t size) {
+    size_t total = PAGE_ROUND(CHUNK_HEADER + size);
+    arena_chunk_t *chunk = mmap(NULL, total, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (chunk == MAP_FAILED) return NULL;
+
+    chunk->next = NULL;
+    chunk->size = total - CHUNK_HEADER;
+    chunk->used = 0;
+    return chunk;
+}
+
+// Premier octet utilisable de la tranche (la première loge l'arène)
+static size_t chunk_base(const arena_t *arena, const arena_chunk_t *chunk) {
+    return (chunk == arena->first) ? ARENA_SELF : 0;
+}
+
+arena_t *arena_create(size_t chunk_size) {
+    if (chunk_size == 0) chunk_size = ARENA_DEFAULT_CHUNK;
+
+    arena_chunk_t *first = chunk_new(ARENA_SELF + chunk_size);
+    if (first == NULL) return NULL;
+
+    arena_t *arena = (arena_t *)CHUNK_DATA(first);
+    arena->first = first;
+    arena->current = first;
+    arena->chunk_size = chunk_size;
+    first->used = ARENA_SELF;
+    return arena;
+}
+
+void *arena_alloc(arena_t *arena, size_t size) {
+    size = ALIGN(size ? size : 1);
+
+    arena_chunk_t *chunk = arena->current;
+    while (chunk->size - chunk->used < size) {
+        if (chunk->next == NULL) {
+            chunk->next = chunk_new(size > arena->chunk_size ? size : arena->chunk_size);
+            if (chunk->next == NULL) return NULL;
+        }
+        chunk = chunk->next;
+    }
+
+    arena->current = chunk;
+    void *ptr = CHUNK_DATA(chunk) + chunk->used;
+    chunk->used += size;
+    return ptr;
+}
+
+void arena_reset(arena_t *arena) {
+    for (arena_chunk_t *chunk = arena->first; chunk != NULL; chunk = chunk->next) {
+        size_t base = chunk_base(arena, chunk);
+        memset(CHUNK_DATA(chunk) + base, 0, chunk->used - base);
+        chunk->used = base;
+    }
+    arena->current = arena->first;
+}
+
+void arena_destroy(arena_t *arena) {
+    if (arena == NULL) return;
+
+    arena_reset(arena);
+
+    // La première tranche (qui contient l'arène) est libérée en dernier
+    arena_chunk_t *first = arena->first;
+    arena_chunk_t *chunk = first->next;
+    while (chunk != NULL) {
+        arena_chunk_t *next = chunk->next;
+        munmap(chunk, CHUNK_HEADER + chunk->size);
+        chunk = next;
+    }
+    munmap(first, CHUNK_HEADER + first->size);
+}
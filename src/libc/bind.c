@@ -0,0 +1,29 @@
+/*
+ * bind.c - Appel système bind()
+ * 
+ * bind() attache une socket à une adresse (chemin pour AF_UNIX).
+ * Utilise le syscall 49 sur Linux x86_64.
+ * 
+ * Paramètres:
+ * - sockfd: socket
+ * - addr, addrlen: adresse (struct sockaddr_un)
+ * 
+ * Retour: 0 en cas de succès, valeur négative en cas d'erreur
+ */
+
+#include "libc/libc.h"
+
+int bind(int sockfd, const void *addr, unsigned int addrlen) {
+    long ret;
+    __asm__ volatile (
+        "syscall"
+        : "=a" (ret)
+        : "a"(49L),
+          "D"((long)sockfd),
+          "S"(addr),
+          "d"((long)addrlen)
+        : "rcx", "r11", "memory"
+    );
+    STATS_SYSCALL(STAT_SYS_BIND, ret);
+    return (int)ret;
+}
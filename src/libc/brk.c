@@ -11,12 +11,12 @@
 void *brk(void *addr) {
     void *result;
     __asm__ volatile (
-        "mov $12, %%rax\n"
-        "mov %1, %%rdi\n"
         "syscall\n"
         : "=a" (result)
-        : "D" (addr)
-        : 
+        : "a" (12L),
+          "D" (addr)
+        : "rcx", "r11", "memory"
     );
+    STATS_SYSCALL(STAT_SYS_BRK, result);
     return result;
-}
\ No newline at end of file
+}
@@ -0,0 +1,27 @@
+/*
+ * clock_gettime.c - Appel système clock_gettime()
+ * 
+ * clock_gettime() lit une horloge du système.
+ * Utilise le syscall 228 sur Linux x86_64.
+ * 
+ * Paramètres:
+ * - clock_id: CLOCK_REALTIME ou CLOCK_MONOTONIC (mesure de durées)
+ * - ts: reçoit secondes et nanosecondes
+ * 
+ * Retour: 0 en cas de succès, valeur négative en cas d'erreur
+ */
+
+#include "libc/libc.h"
+
+int clock_gettime(int clock_id, struct timespec *ts) {
+    long ret;
+    __asm__ volatile (
+        "syscall"
+        : "=a" (ret)
+        : "a"(228L),
+          "D"((long)clock_id),
+          "S"(ts)
+        : "rcx", "r11", "memory"
+    );
+    return (int)ret;
+}
@@ -0,0 +1,59 @@
+/*
+ * clone.c - Appel système clone() pour créer un thread
+ * 
+ * clone() crée une tâche qui partage (selon flags) la mémoire, les
+ * descripteurs et les signaux du processus.
+ * Utilise le syscall 56 sur Linux x86_64.
+ * 
+ * L'enfant démarre sur `stack` sans cadre d'appel valide: il ne peut pas
+ * revenir dans du code C. fn et arg sont donc posés au sommet de la nouvelle
+ * pile avant l'appel; l'enfant les dépile, appelle fn(arg) et termine avec
+ * le syscall exit (60), qui ne termine que ce thread.
+ * 
+ * Paramètres:
+ * - fn, arg: fonction exécutée par l'enfant et son argument
+ * - stack: sommet de la pile de l'enfant (aligné sur 16 octets)
+ * - flags: CLONE_*
+ * - parent_tid: reçoit le TID dans le parent (CLONE_PARENT_SETTID)
+ * - child_tid: remis à 0 à la fin de l'enfant (CLONE_CHILD_CLEARTID)
+ * 
+ * Retour: TID de l'enfant dans le parent, valeur négative en cas d'erreur
+ */
+
+#include "libc/libc.h"
+
+int clone(int (*fn)(void *), void *arg, void *stack, unsigned long flags, int *parent_tid, int *child_tid) {
+    long ret;
+    void **sp = (void **)stack;
+
+    *--sp = arg;
+    *--sp = (void *)fn;
+
+    register long child_tid_reg asm("r10") = (long)child_tid;
+    register long tls_reg asm("r8") = 0;
+
+    __asm__ volatile (
+        "syscall\n"
+        "test %%rax, %%rax\n"
+        "jnz 1f\n"
+        // Enfant: nouvelle pile, fn et arg au sommet
+        "xor %%ebp, %%ebp\n"
+        "pop %%rax\n"
+        "pop %%rdi\n"
+        "call *%%rax\n"
+        "mov %%eax, %%edi\n"
+        "mov $60, %%eax\n"
+        "syscall\n"
+        "1:\n"
+        : "=a" (ret)
+        : "a"(56L),
+          "D"(flags),
+          "S"(sp),
+          "d"(parent_tid),
+          "r"(child_tid_reg),
+          "r"(tls_reg)
+        : "rcx", "r11", "memory"
+    );
+    STATS_SYSCALL(STAT_SYS_CLONE, ret);
+    return (int)ret;
+}
@@ -1,7 +1,8 @@
 /*
  * close.c - Appel système close()
  * 
- * close() ferme un descripteur de fichier.
+ * close() ferme un descripteur de fichier et oublie son tampon de
+ * lecture (le numéro peut être réutilisé par un prochain open()).
  * Utilise le syscall 3 sur Linux x86_64.
  * 
  * Paramètres:
@@ -14,13 +15,14 @@
 
 int close(int fd) {
     long ret;
+    read_discard(fd);
     __asm__ volatile (
-        "mov $3, %%rax\n"   // syscall: close
-        "mov %1, %%rdi\n"   // fd
         "syscall\n"
         : "=a"(ret)
-        : "r"((long)fd)
-        : "rdi"
+        : "a"(3L),          // syscall: close
+          "D"((long)fd)     // fd
+        : "rcx", "r11", "memory"
     );
+    STATS_SYSCALL(STAT_SYS_CLOSE, ret);
     return ret;
 }
\ No newline at end of file
@@ -0,0 +1,29 @@
+/*
+ * connect.c - Appel système connect()
+ * 
+ * connect() connecte une socket à une adresse.
+ * Utilise le syscall 42 sur Linux x86_64.
+ * 
+ * Paramètres:
+ * - sockfd: socket
+ * - addr, addrlen: adresse du serveur (struct sockaddr_un)
+ * 
+ * Retour: 0 en cas de succès, valeur négative en cas d'erreur
+ */
+
+#include "libc/libc.h"
+
+int connect(int sockfd, const void *addr, unsigned int addrlen) {
+    long ret;
+    __asm__ volatile (
+        "syscall"
+        : "=a" (ret)
+        : "a"(42L),
+          "D"((long)sockfd),
+          "S"(addr),
+          "d"((long)addrlen)
+        : "rcx", "r11", "memory"
+    );
+    STATS_SYSCALL(STAT_SYS_CONNECT, ret);
+    return (int)ret;
+}
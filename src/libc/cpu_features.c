@@ -0,0 +1,61 @@
+/*
+ * cpu_features.c - Détection des extensions du processeur
+ *
+ * Interroge cpuid une seule fois et met le résultat en cache.
+ * AVX2 n'est annoncé que si le système sauvegarde aussi les registres
+ * ymm (bit OSXSAVE puis xgetbv), sinon les instructions fauteraient.
+ *
+ * Retour: masque de bits CPU_FEATURE_*
+ */
+
+#include "libc/libc.h"
+
+static void cpuid(unsigned int leaf, unsigned int subleaf, unsigned int regs[4]) {
+    __asm__ volatile (
+        "cpuid\n"
+        : "=a" (regs[0]), "=b" (regs[1]), "=c" (regs[2]), "=d" (regs[3])
+        : "a" (leaf), "c" (subleaf)
+    );
+}
+
+static unsigned long long xgetbv(unsigned int index) {
+    unsigned int lo, hi;
+    __asm__ volatile (
+        "xgetbv\n"
+        : "=a" (lo), "=d" (hi)
+        : "c" (index)
+    );
+    return ((unsigned long long)hi << 32) | lo;
+}
+
+unsigned int cpu_features(void) {
+    static int detected = 0;
+    static unsigned int features = 0;
+    unsigned int regs[4];
+
+    if (detected) {
+        return features;
+    }
+
+    cpuid(0, 0, regs);
+    unsigned int max_leaf = regs[0];
+
+    cpuid(1, 0, regs);
+    if (regs[3] & (1u << 26)) {
+        features |= CPU_FEATURE_SSE2;
+    }
+
+    // OSXSAVE (bit 27) + AVX (bit 28), puis état xmm|ymm activé par le noyau
+    int os_avx = (regs[2] & (1u << 27)) && (regs[2] & (1u << 28))
+                 && ((xgetbv(0) & 6) == 6);
+
+    if (os_avx && max_leaf >= 7) {
+        cpuid(7, 0, regs);
+        if (regs[1] & (1u << 5)) {
+            features |= CPU_FEATURE_AVX2;
+        }
+    }
+
+    detected = 1;
+    return features;
+}
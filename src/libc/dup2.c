@@ -20,7 +20,8 @@ int dup2(int oldfd, int newfd) {
         "syscall\n"
         : "=a" (result)
         : "D" (oldfd), "S" (newfd)
-        :
+        : "rcx", "r11", "memory"
     );
+    STATS_SYSCALL(STAT_SYS_DUP2, result);
     return result;
 }
\ No newline at end of file
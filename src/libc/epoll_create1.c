@@ -0,0 +1,26 @@
+/*
+ * epoll_create1.c - Appel système epoll_create1()
+ * 
+ * epoll_create1() crée une instance epoll.
+ * Utilise le syscall 291 sur Linux x86_64.
+ * 
+ * Paramètres:
+ * - flags: 0 ou EPOLL_CLOEXEC
+ * 
+ * Retour: descripteur epoll, valeur négative en cas d'erreur
+ */
+
+#include "libc/libc.h"
+
+int epoll_create1(int flags) {
+    long ret;
+    __asm__ volatile (
+        "syscall"
+        : "=a" (ret)
+        : "a"(291L),
+          "D"((long)flags)
+        : "rcx", "r11", "memory"
+    );
+    STATS_SYSCALL(STAT_SYS_EPOLL_CREATE1, ret);
+    return (int)ret;
+}
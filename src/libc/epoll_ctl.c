@@ -0,0 +1,33 @@
+/*
+ * epoll_ctl.c - Appel système epoll_ctl()
+ * 
+ * epoll_ctl() ajoute, modifie ou retire un descripteur surveillé.
+ * Utilise le syscall 233 sur Linux x86_64.
+ * 
+ * Paramètres:
+ * - epfd: instance epoll
+ * - op: EPOLL_CTL_ADD / EPOLL_CTL_MOD / EPOLL_CTL_DEL
+ * - fd: descripteur surveillé
+ * - event: événements attendus et donnée associée
+ * 
+ * Retour: 0 en cas de succès, valeur négative en cas d'erreur
+ */
+
+#include "libc/libc.h"
+
+int epoll_ctl(int epfd, int op, int fd, struct epoll_event *event) {
+    long ret;
+    register long event_reg asm("r10") = (long)event;
+    __asm__ volatile (
+        "syscall"
+        : "=a" (ret)
+        : "a"(233L),
+          "D"((long)epfd),
+          "S"((long)op),
+          "d"((long)fd),
+          "r"(event_reg)
+        : "rcx", "r11", "memory"
+    );
+    STATS_SYSCALL(STAT_SYS_EPOLL_CTL, ret);
+    return (int)ret;
+}
@@ -0,0 +1,32 @@
+/*
+ * epoll_wait.c - Appel système epoll_wait()
+ * 
+ * epoll_wait() attend des événements sur une instance epoll.
+ * Utilise le syscall 232 sur Linux x86_64.
+ * 
+ * Paramètres:
+ * - epfd: instance epoll
+ * - events, maxevents: tableau de résultats
+ * - timeout: en millisecondes, -1 = sans limite
+ * 
+ * Retour: nombre d'événements (0 si le délai expire), valeur négative en cas d'erreur
+ */
+
+#include "libc/libc.h"
+
+int epoll_wait(int epfd, struct epoll_event *events, int maxevents, int timeout) {
+    long ret;
+    register long timeout_reg asm("r10") = timeout;
+    __asm__ volatile (
+        "syscall"
+        : "=a" (ret)
+        : "a"(232L),
+          "D"((long)epfd),
+          "S"(events),
+          "d"((long)maxevents),
+          "r"(timeout_reg)
+        : "rcx", "r11", "memory"
+    );
+    STATS_SYSCALL(STAT_SYS_EPOLL_WAIT, ret);
+    return (int)ret;
+}
@@ -21,5 +21,6 @@ int execve(const char *pathname, char *const argv[], char *const envp[]) {
         : "D" (pathname), "S" (argv), "d" (envp)
         :
     );
+    STATS_SYSCALL(STAT_SYS_EXECVE, result);
     return result;
 }
\ No newline at end of file
@@ -1,8 +1,11 @@
 #include "libc/libc.h" 
 
 void exit(int status) {
+    // Vide la sortie tamponnée avant de quitter
+    stdout_flush();
+
     __asm__ volatile (
-        "mov $60, %%rax\n"     // syscall: exit
+        "mov $231, %%rax\n"    // syscall: exit_group (termine aussi les threads)
         "mov %0, %%rdi\n"      // status
         "syscall\n"
         :
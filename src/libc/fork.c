@@ -8,6 +8,8 @@
  * - Dans le processus parent: PID du processus enfant
  * - Dans le processus enfant: 0
  * - En cas d'erreur: -1
+ * 
+ * L'enfant n'a que le thread appelant: le pool de threads y est remis à zéro.
  */
 
 #include "libc/libc.h"
@@ -19,7 +21,9 @@ int fork(void) {
         "syscall\n"
         : "=a" (result)
         :
-        :
+        : "rcx", "r11", "memory"
     );
+    STATS_SYSCALL(STAT_SYS_FORK, result);
+    if (result == 0) pool_after_fork();
     return result;
 }
\ No newline at end of file
@@ -4,40 +4,30 @@
  * Fonctionnement:
  * 1. Récupère le header depuis le pointeur utilisateur
  * 2. Vérifie que le bloc n'est pas déjà libre (double-free)
- * 3. Marque le bloc comme libre (bit 0 = 0)
- * 4. Ajoute le bloc en tête de la free list
+ * 3. Un bloc projeté par mmap() est rendu directement au système
+ * 4. Sinon, fusionne le bloc avec ses voisins libres (étiquettes de
+ *    frontière), le range dans la liste de sa classe de taille et rend
+ *    le haut du heap à brk() s'il est devenu assez grand
  */
 
 #include "libc/libc.h"
 
-typedef struct free_block {
-    struct free_block *next;
-} free_block_t;
-
-extern free_block_t *free_list;
-
-static block_header_t *get_header(void *ptr) {
-    return (block_header_t *)((char *)ptr - sizeof(block_header_t));
-}
-
-static void *get_data(block_header_t *header) {
-    return (char *)header + sizeof(block_header_t);
-}
-
 void free(void *ptr) {
-    if (ptr == (void *)0) {
+    if (ptr == NULL) {
         return;
     }
     
-    block_header_t *header = get_header(ptr);
+    block_header_t *header = DATA_BLOCK(ptr);
     
     if (IS_FREE(header)) {
         return;
     }
     
-    SET_FREE(header);
+    if (IS_MMAPPED(header)) {
+        heap_mmap_free(header);
+        return;
+    }
     
-    free_block_t *new_free = (free_block_t *)get_data(header);
-    new_free->next = free_list;
-    free_list = new_free;
-}
\ No newline at end of file
+    heap_release(header);
+    heap_trim();
+}
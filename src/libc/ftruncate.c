@@ -0,0 +1,25 @@
+/*
+ * ftruncate.c - Appel système ftruncate()
+ * 
+ * ftruncate() fixe la taille d'un fichier ouvert en écriture
+ * (nécessaire avant de le projeter avec mmap()).
+ * Utilise le syscall 77 sur Linux x86_64.
+ * 
+ * Retour: 0 en cas de succès, valeur négative en cas d'erreur
+ */
+
+#include "libc/libc.h"
+
+int ftruncate(int fd, long length) {
+    long ret;
+    __asm__ volatile (
+        "syscall"
+        : "=a" (ret)
+        : "a"(77L),
+          "D"((long)fd),
+          "S"(length)
+        : "rcx", "r11", "memory"
+    );
+    STATS_SYSCALL(STAT_SYS_FTRUNCATE, ret);
+    return (int)ret;
+}
@@ -0,0 +1,37 @@
+/*
+ * futex.c - Appel système futex()
+ * 
+ * futex() attend qu'un mot en mémoire change (FUTEX_WAIT) ou réveille
+ * les threads qui l'attendent (FUTEX_WAKE).
+ * Utilise le syscall 202 sur Linux x86_64.
+ * 
+ * Paramètres:
+ * - uaddr: adresse du mot surveillé
+ * - op: FUTEX_WAIT ou FUTEX_WAKE (éventuellement | FUTEX_PRIVATE_FLAG)
+ * - val: WAIT: valeur attendue de *uaddr (sinon retour immédiat);
+ *        WAKE: nombre maximal de threads réveillés
+ * - timeout: durée maximale d'attente (WAIT), NULL pour aucune
+ * 
+ * Retour: WAKE: nombre de threads réveillés; WAIT: 0;
+ * valeur négative en cas d'erreur (-EAGAIN si *uaddr != val)
+ */
+
+#include "libc/libc.h"
+
+long futex(int *uaddr, int op, int val, const struct timespec *timeout) {
+    long ret;
+    register long timeout_reg asm("r10") = (long)timeout;
+
+    __asm__ volatile (
+        "syscall"
+        : "=a" (ret)
+        : "a"(202L),
+          "D"(uaddr),
+          "S"((long)op),
+          "d"((long)val),
+          "r"(timeout_reg)
+        : "rcx", "r11", "memory"
+    );
+    STATS_SYSCALL(STAT_SYS_FUTEX, ret);
+    return ret;
+}
@@ -2,38 +2,57 @@
 
 #define GETLINE_INITIAL_SIZE 128
 
+// Agrandit *lineptr (par doublement) pour contenir au moins needed octets
+static int grow_line(char **lineptr, size_t *n, size_t needed) {
+    size_t new_size = *n;
+    while (new_size < needed) {
+        new_size *= 2;
+    }
+
+    char *p = realloc(*lineptr, new_size);
+    if (p == NULL) return -1;
+
+    *lineptr = p;
+    *n = new_size;
+    return 0;
+}
+
 ssize_t getline(char **lineptr, size_t *n, int fd) {
     if (!lineptr || !n) return -1;
     
     // Allouer le buffer initial si nécessaire
-    if (*lineptr == 0 || *n == 0) {
-        // Pour cette mini libc, on va utiliser un buffer statique
-        // Dans une vraie implémentation, il faudrait malloc
-        static char static_buffer[GETLINE_INITIAL_SIZE];
-        *lineptr = static_buffer;
+    if (*lineptr == NULL || *n == 0) {
         *n = GETLINE_INITIAL_SIZE;
+        if (grow_line(lineptr, n, GETLINE_INITIAL_SIZE) < 0) return -1;
     }
     
+    if (fd == 0) stdout_flush(); // l'invite doit être visible avant de lire
+
     size_t pos = 0;
-    char c;
-    ssize_t bytes_read;
     
-    while ((bytes_read = read(fd, &c, 1)) > 0) {
-        if (pos >= *n - 1) {
-            // Buffer trop petit - dans une vraie implémentation, on realloc
+    for (;;) {
+        const char *data;
+        ssize_t avail = read_buffered(fd, &data);
+        if (avail < 0) return -1;
+        if (avail == 0) break; // EOF
+
+        // Recherche du saut de ligne sur tout le tampon disponible
+        const char *nl = memchr(data, '\n', avail);
+        size_t take = nl ? (size_t)(nl - data) + 1 : (size_t)avail;
+
+        if (pos + take + 1 > *n && grow_line(lineptr, n, pos + take + 1) < 0) {
             return -1;
         }
-        
-        (*lineptr)[pos++] = c;
-        
-        if (c == '\n') {
-            break;
-        }
+
+        memcpy(*lineptr + pos, data, take);
+        read_consume(fd, take);
+        pos += take;
+
+        if (nl) break;
     }
     
-    if (bytes_read < 0) return -1;
-    if (pos == 0 && bytes_read == 0) return -1; // EOF
+    if (pos == 0) return -1; // EOF
     
     (*lineptr)[pos] = '\0';
     return pos;
-}
\ No newline at end of file
+}
@@ -16,5 +16,6 @@ int getpid(void) {
         :
         :
     );
+    STATS_SYSCALL(STAT_SYS_GETPID, result);
     return result;
 }
\ No newline at end of file
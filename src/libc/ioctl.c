@@ -0,0 +1,32 @@
+/*
+ * ioctl.c - Appel système ioctl()
+ * 
+ * ioctl() envoie une requête de contrôle propre au périphérique
+ * derrière un descripteur (ici: terminal).
+ * Utilise le syscall 16 sur Linux x86_64.
+ * 
+ * Paramètres:
+ * - fd: descripteur visé
+ * - request: code de la requête (ex. TCGETS)
+ * - arg: argument de la requête (structure lue ou écrite)
+ * 
+ * Retour: 0 (ou valeur propre à la requête), valeur négative en cas d'erreur
+ */
+
+#include "libc/libc.h"
+
+int ioctl(int fd, unsigned long request, void *arg) {
+    long ret;
+
+    __asm__ volatile (
+        "syscall"
+        : "=a" (ret)
+        : "a"(16L),
+          "D"((long)fd),
+          "S"(request),
+          "d"(arg)
+        : "rcx", "r11", "memory"
+    );
+    STATS_SYSCALL(STAT_SYS_IOCTL, ret);
+    return (int)ret;
+}
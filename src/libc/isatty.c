@@ -0,0 +1,18 @@
+/*
+ * isatty.c - Le descripteur est-il un terminal ?
+ * 
+ * Demande les attributs du terminal (TCGETS): seul un terminal sait
+ * y répondre.
+ * 
+ * Retour: 1 si fd est un terminal, 0 sinon
+ */
+
+#include "libc/libc.h"
+
+#define TERMIOS_SIZE 64   // struct termios du noyau: 60 octets
+
+int isatty(int fd) {
+    unsigned char termios[TERMIOS_SIZE];
+
+    return ioctl(fd, TCGETS, termios) == 0;
+}
@@ -0,0 +1,34 @@
+/*
+ * keyctl.c - Appel système keyctl()
+ * 
+ * keyctl() manipule une clé existante: lecture du contenu,
+ * délai d'expiration, invalidation...
+ * Utilise le syscall 250 sur Linux x86_64.
+ * 
+ * Paramètres:
+ * - operation: KEYCTL_READ / KEYCTL_SET_TIMEOUT / KEYCTL_INVALIDATE...
+ * - arg2..arg5: arguments propres à l'opération (0 si inutilisés)
+ * 
+ * Retour: dépend de l'opération, valeur négative en cas d'erreur
+ */
+
+#include "libc/libc.h"
+
+long keyctl(int operation, unsigned long arg2, unsigned long arg3, unsigned long arg4, unsigned long arg5) {
+    long ret;
+    register unsigned long arg4_reg asm("r10") = arg4;
+    register unsigned long arg5_reg asm("r8") = arg5;
+    __asm__ volatile (
+        "syscall"
+        : "=a" (ret)
+        : "a"(250L),
+          "D"((long)operation),
+          "S"(arg2),
+          "d"(arg3),
+          "r"(arg4_reg),
+          "r"(arg5_reg)
+        : "rcx", "r11", "memory"
+    );
+    STATS_SYSCALL(STAT_SYS_KEYCTL, ret);
+    return ret;
+}
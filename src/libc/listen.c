@@ -0,0 +1,28 @@
+/*
+ * listen.c - Appel système listen()
+ * 
+ * listen() met une socket en attente de connexions.
+ * Utilise le syscall 50 sur Linux x86_64.
+ * 
+ * Paramètres:
+ * - sockfd: socket liée par bind()
+ * - backlog: nombre de connexions en attente
+ * 
+ * Retour: 0 en cas de succès, valeur négative en cas d'erreur
+ */
+
+#include "libc/libc.h"
+
+int listen(int sockfd, int backlog) {
+    long ret;
+    __asm__ volatile (
+        "syscall"
+        : "=a" (ret)
+        : "a"(50L),
+          "D"((long)sockfd),
+          "S"((long)backlog)
+        : "rcx", "r11", "memory"
+    );
+    STATS_SYSCALL(STAT_SYS_LISTEN, ret);
+    return (int)ret;
+}
@@ -0,0 +1,26 @@
+/*
+ * lseek.c - Appel système lseek()
+ * 
+ * lseek() déplace l'offset d'un descripteur de fichier.
+ * Utilise le syscall 8 sur Linux x86_64.
+ * lseek(fd, 0, SEEK_END) donne la taille du fichier.
+ * 
+ * Retour: nouvel offset, ou valeur négative en cas d'erreur
+ */
+
+#include "libc/libc.h"
+
+long lseek(int fd, long offset, int whence) {
+    long ret;
+    __asm__ volatile (
+        "syscall"
+        : "=a" (ret)
+        : "a"(8L),
+          "D"((long)fd),
+          "S"(offset),
+          "d"((long)whence)
+        : "rcx", "r11", "memory"
+    );
+    STATS_SYSCALL(STAT_SYS_LSEEK, ret);
+    return ret;
+}
@@ -1,70 +1,287 @@
 /*
- * malloc.c - Allocation de mémoire avec free list
+ * malloc.c - Allocation de mémoire par classes de taille
  * 
  * Fonctionnement:
- * 1. Cherche un bloc libre dans la free list (first-fit)
- * 2. Si trouvé: le retire de la liste et le marque occupé
- * 3. Sinon: étend le heap avec sbrk() et crée un nouveau bloc
+ * 1. Les blocs libres sont rangés dans 128 listes doublement chaînées:
+ *    - 63 classes exactes de 32 à 1024 octets (pas de 16)
+ *    - puis une classe par puissance de deux au-delà
+ * 2. Un bitmap des listes non vides donne en une instruction la première
+ *    classe suffisante: malloc() est O(1) pour les petites tailles
+ * 3. Un bloc trop grand est découpé, le reste retourne dans sa classe
+ * 4. Sans bloc libre, le heap est étendu avec sbrk() par tranches de
+ *    HEAP_CHUNK, et la tranche est fusionnée avec un éventuel bloc libre final
+ * 5. Au-delà de MMAP_THRESHOLD, le bloc est projeté à part par mmap() et
+ *    rendu au système dès free() (redimensionné par mremap() dans realloc)
+ * 6. free() rend le haut du heap à brk() quand le dernier bloc libre dépasse
+ *    HEAP_TRIM_THRESHOLD
  * 
+ * Le heap est borné par un épilogue (header de taille 0, occupé) pour que
+ * la fusion n'ait jamais à tester la fin du heap.
  * Tous les blocs sont alignés sur 16 bytes
  */
 
 #include "libc/libc.h"
 
+#define SMALL_BIN_LIMIT 1024
+#define BIN_COUNT       128
+#define HEAP_CHUNK      (64 * 1024)
+#define HEAP_TRIM_THRESHOLD (256 * 1024)
+#define PAGE_ROUND(n)   (((n) + 4095) & ~(size_t)4095)
+
+// Un bloc projeté: [8 octets libres][header][données alignées sur 16]
+#define MMAP_OFFSET     sizeof(block_header_t)
+
 typedef struct free_block {
+    block_header_t header;
     struct free_block *next;
+    struct free_block *prev;
 } free_block_t;
 
-free_block_t *free_list = (void *)0;
+static free_block_t *bins[BIN_COUNT];
+static unsigned long long bin_map[BIN_COUNT / 64];
+static block_header_t *epilogue = NULL;
 
-static block_header_t *get_header(void *ptr) {
-    return (block_header_t *)((char *)ptr - sizeof(block_header_t));
+static int bin_index(size_t size) {
+    if (size <= SMALL_BIN_LIMIT) {
+        return (int)(size >> 4) - 2;
+    }
+    // 1025..2047 -> 63, 2048..4095 -> 64, ...
+    return 63 + (63 - __builtin_clzll(size)) - 10;
 }
 
-static void *get_data(block_header_t *header) {
-    return (char *)header + sizeof(block_header_t);
+static void bin_insert(block_header_t *block) {
+    int i = bin_index(GET_SIZE(block));
+    free_block_t *fb = (free_block_t *)block;
+
+    fb->prev = NULL;
+    fb->next = bins[i];
+    if (bins[i] != NULL) {
+        bins[i]->prev = fb;
+    }
+    bins[i] = fb;
+    bin_map[i / 64] |= 1ULL << (i % 64);
 }
 
-static block_header_t *find_free_block(size_t size) {
-    free_block_t *current = free_list;
-    free_block_t *prev = (void *)0;
-    
-    while (current != (void *)0) {
-        block_header_t *header = get_header(current);
-        if (GET_SIZE(header) >= size) {
-            if (prev == (void *)0) {
-                free_list = current->next;
-            } else {
-                prev->next = current->next;
+void heap_bin_remove(block_header_t *block) {
+    int i = bin_index(GET_SIZE(block));
+    free_block_t *fb = (free_block_t *)block;
+
+    if (fb->prev != NULL) {
+        fb->prev->next = fb->next;
+    } else {
+        bins[i] = fb->next;
+    }
+    if (fb->next != NULL) {
+        fb->next->prev = fb->prev;
+    }
+    if (bins[i] == NULL) {
+        bin_map[i / 64] &= ~(1ULL << (i % 64));
+    }
+}
+
+/**
+ * Marque block libre, le fusionne avec ses voisins libres et le range.
+ */
+void heap_release(block_header_t *block) {
+    size_t size = GET_SIZE(block);
+    block_header_t *next = NEXT_BLOCK(block);
+
+    if (IS_FREE(next)) {
+        heap_bin_remove(next);
+        size += GET_SIZE(next);
+    }
+    if (IS_PREV_FREE(block)) {
+        size_t prev_size = *((size_t *)block - 1);
+        block = (block_header_t *)((char *)block - prev_size);
+        heap_bin_remove(block);
+        size += prev_size;
+    }
+
+    block->size = size | (block->size & BLOCK_PREV_USED);
+    *(size_t *)((char *)block + size - sizeof(size_t)) = size;
+    NEXT_BLOCK(block)->size &= ~(size_t)BLOCK_PREV_USED;
+    bin_insert(block);
+}
+
+/**
+ * Réduit le bloc occupé block à size octets si le reste forme un bloc.
+ */
+void heap_split(block_header_t *block, size_t size) {
+    size_t total = GET_SIZE(block);
+    if (total - size < MIN_BLOCK_SIZE) {
+        return;
+    }
+
+    block->size = size | (block->size & BLOCK_FLAGS);
+    block_header_t *rest = NEXT_BLOCK(block);
+    rest->size = (total - size) | BLOCK_PREV_USED;
+    heap_release(rest);
+}
+
+static block_header_t *find_fit(size_t size) {
+    int i = bin_index(size);
+
+    // Classe large: premier bloc suffisant de la classe elle-même
+    if (size > SMALL_BIN_LIMIT) {
+        for (free_block_t *fb = bins[i]; fb != NULL; fb = fb->next) {
+            if (GET_SIZE(&fb->header) >= size) {
+                return &fb->header;
             }
-            return header;
         }
-        prev = current;
-        current = current->next;
+        i++;
+    }
+
+    // Sinon tout bloc d'une classe non vide >= i convient
+    for (int w = i / 64; w < BIN_COUNT / 64; w++) {
+        unsigned long long map = bin_map[w];
+        if (w == i / 64) {
+            map &= ~0ULL << (i % 64);
+        }
+        if (map != 0) {
+            return &bins[w * 64 + __builtin_ctzll(map)]->header;
+        }
+    }
+    return NULL;
+}
+
+static int heap_grow(size_t size) {
+    if (epilogue == NULL) {
+        // Premier header à 8 mod 16 pour que les données soient alignées
+        char *base = sbrk(0);
+        size_t pad = (24 - ((unsigned long)base & 15)) & 15;
+        if (sbrk(pad + sizeof(block_header_t)) == (void *)-1) {
+            return -1;
+        }
+        epilogue = (block_header_t *)(base + pad);
+        epilogue->size = BLOCK_USED | BLOCK_PREV_USED;
+    }
+
+    // Un bloc libre en haut du heap sera fusionné: seul le manque est demandé
+    if (IS_PREV_FREE(epilogue)) {
+        size_t top = *((size_t *)epilogue - 1);
+        size = (size > top) ? size - top : 0;
+    }
+    size_t chunk = (size < HEAP_CHUNK) ? HEAP_CHUNK : ALIGN(size);
+    if (sbrk(chunk) == (void *)-1) {
+        return -1;
+    }
+
+    // L'ancien épilogue devient le header de la nouvelle tranche
+    block_header_t *block = epilogue;
+    block->size = chunk | (block->size & BLOCK_PREV_USED) | BLOCK_USED;
+    epilogue = NEXT_BLOCK(block);
+    epilogue->size = BLOCK_USED | BLOCK_PREV_USED;
+
+    heap_release(block);
+    return 0;
+}
+
+/**
+ * Agrandit sur place le bloc occupé block jusqu'à size octets, en absorbant
+ * le bloc libre suivant ou, en haut du heap, en étendant le heap.
+ */
+int heap_extend(block_header_t *block, size_t size) {
+    block_header_t *next = NEXT_BLOCK(block);
+    int at_top = (next == epilogue) || (IS_FREE(next) && NEXT_BLOCK(next) == epilogue);
+
+    if (GET_SIZE(block) + (IS_FREE(next) ? GET_SIZE(next) : 0) < size) {
+        if (!at_top || heap_grow(size - GET_SIZE(block)) < 0) {
+            return -1;
+        }
+        next = NEXT_BLOCK(block);
     }
-    return (void *)0;
+
+    heap_bin_remove(next);
+    block->size += GET_SIZE(next);
+    NEXT_BLOCK(block)->size |= BLOCK_PREV_USED;
+    heap_split(block, size);
+    return 0;
+}
+
+/**
+ * Rend à brk() le haut du heap s'il est libre et dépasse HEAP_TRIM_THRESHOLD,
+ * en gardant HEAP_CHUNK octets pour les allocations suivantes.
+ */
+void heap_trim(void) {
+    if (epilogue == NULL || !IS_PREV_FREE(epilogue)) {
+        return;
+    }
+
+    size_t size = *((size_t *)epilogue - 1);
+    if (size < HEAP_TRIM_THRESHOLD) {
+        return;
+    }
+
+    block_header_t *top = (block_header_t *)((char *)epilogue - size);
+    size_t release = (size - HEAP_CHUNK) & ~(size_t)4095;
+    if (sbrk(-(long)release) == (void *)-1) {
+        return;
+    }
+
+    heap_bin_remove(top);
+    size -= release;
+    top->size = size | (top->size & BLOCK_PREV_USED);
+    *(size_t *)((char *)top + size - sizeof(size_t)) = size;
+    epilogue = NEXT_BLOCK(top);
+    epilogue->size = BLOCK_USED;
+    bin_insert(top);
+}
+
+void *heap_mmap_alloc(size_t size) {
+    size_t length = PAGE_ROUND(MMAP_OFFSET + sizeof(block_header_t) + size);
+    char *base = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        return NULL;
+    }
+
+    block_header_t *header = (block_header_t *)(base + MMAP_OFFSET);
+    header->size = length | BLOCK_MMAPPED | BLOCK_USED;
+    return BLOCK_DATA(header);
+}
+
+/**
+ * Redimensionne un bloc projeté avec mremap(): les pages sont déplacées
+ * par le noyau, sans copie.
+ */
+void *heap_mmap_resize(block_header_t *block, size_t size) {
+    char *base = (char *)block - MMAP_OFFSET;
+    size_t length = PAGE_ROUND(MMAP_OFFSET + sizeof(block_header_t) + size);
+
+    base = mremap(base, GET_SIZE(block), length, MREMAP_MAYMOVE);
+    if (base == MAP_FAILED) {
+        return NULL;
+    }
+
+    block_header_t *header = (block_header_t *)(base + MMAP_OFFSET);
+    header->size = length | BLOCK_MMAPPED | BLOCK_USED;
+    return BLOCK_DATA(header);
+}
+
+void heap_mmap_free(block_header_t *block) {
+    munmap((char *)block - MMAP_OFFSET, GET_SIZE(block));
 }
 
 void *malloc(size_t size) {
     if (size == 0) size = 8;
     
-    size_t aligned_size = ALIGN(size);
-    
-    block_header_t *header = find_free_block(aligned_size);
-    
-    if (header != (void *)0) {
-        SET_USED(header);
-        return get_data(header);
+    if (size >= MMAP_THRESHOLD) {
+        return heap_mmap_alloc(size);
     }
     
-    size_t total_size = ALIGN(sizeof(block_header_t) + aligned_size);
-    void *new_memory = sbrk(total_size);
-    if (new_memory == (void *)-1) {
-        return (void *)0;
+    size_t block_size = BLOCK_SIZE_FOR(size);
+    
+    block_header_t *header = find_fit(block_size);
+    if (header == NULL) {
+        if (heap_grow(block_size) < 0) {
+            return NULL;
+        }
+        header = find_fit(block_size);
     }
     
-    header = (block_header_t *)new_memory;
-    header->size = aligned_size | 1;
+    heap_bin_remove(header);
+    SET_USED(header);
+    NEXT_BLOCK(header)->size |= BLOCK_PREV_USED;
+    heap_split(header, block_size);
     
-    return get_data(header);
+    return BLOCK_DATA(header);
 }
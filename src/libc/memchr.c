@@ -0,0 +1,82 @@
+/*
+ * memchr.c - Recherche d'un octet dans une zone mémoire
+ * 
+ * Versions AVX2 / SSE2 (choisies au premier appel) et octet par octet.
+ * Les lectures vectorielles sont alignées: elles peuvent déborder de la zone
+ * mais jamais de la page, et les correspondances hors zone sont ignorées.
+ */
+
+#include "libc/libc.h"
+#include "libc/simd.h"
+
+static void *memchr_byte(const void *s, int c, size_t n) {
+    const unsigned char *p = s;
+
+    while (n--) {
+        if (*p == (unsigned char)c) {
+            return (void *)p;
+        }
+        p++;
+    }
+    return NULL;
+}
+
+static void *memchr_sse2(const void *s, int c, size_t n) {
+    if (n == 0) return NULL;
+
+    size_t off = (unsigned long)s & 15;
+    const v16qi *p = (const v16qi *)((const char *)s - off);
+    v16qi needle = SPLAT16((char)c);
+
+    unsigned int mask = MOVEMASK16(*p == needle) >> off;
+    size_t left = n + off; // octets restants comptés depuis p
+
+    for (;;) {
+        if (mask) {
+            size_t i = __builtin_ctz(mask);
+            return (i < n) ? (char *)s + i : NULL;
+        }
+        if (left <= 16) return NULL;
+        left -= 16;
+        p++;
+        s = p;
+        n = left;
+        mask = MOVEMASK16(*p == needle);
+    }
+}
+
+__attribute__((target("avx2")))
+static void *memchr_avx2(const void *s, int c, size_t n) {
+    if (n == 0) return NULL;
+
+    size_t off = (unsigned long)s & 31;
+    const v32qi *p = (const v32qi *)((const char *)s - off);
+    v32qi needle = SPLAT32((char)c);
+
+    unsigned int mask = MOVEMASK32(*p == needle) >> off;
+    size_t left = n + off;
+
+    for (;;) {
+        if (mask) {
+            size_t i = __builtin_ctz(mask);
+            return (i < n) ? (char *)s + i : NULL;
+        }
+        if (left <= 32) return NULL;
+        left -= 32;
+        p++;
+        s = p;
+        n = left;
+        mask = MOVEMASK32(*p == needle);
+    }
+}
+
+static void *(*memchr_impl)(const void *s, int c, size_t n) = NULL;
+
+void *memchr(const void *s, int c, size_t n) {
+    if (memchr_impl == NULL) {
+        unsigned int features = cpu_features();
+        memchr_impl = (features & CPU_FEATURE_AVX2) ? memchr_avx2
+                    : (features & CPU_FEATURE_SSE2) ? memchr_sse2 : memchr_byte;
+    }
+    return memchr_impl(s, c, n);
+}
@@ -0,0 +1,46 @@
+/*
+ * memcmp.c - Comparaison de deux zones mémoire
+ * 
+ * Version SSE2 (16 octets par comparaison, lectures non alignées dans les
+ * bornes des zones) et version octet par octet, choisie au premier appel.
+ */
+
+#include "libc/libc.h"
+#include "libc/simd.h"
+
+static int memcmp_bytes(const void *s1, const void *s2, size_t n) {
+    const unsigned char *a = s1;
+    const unsigned char *b = s2;
+
+    while (n--) {
+        if (*a != *b) {
+            return *a - *b;
+        }
+        a++;
+        b++;
+    }
+    return 0;
+}
+
+static int memcmp_sse2(const void *s1, const void *s2, size_t n) {
+    const unsigned char *a = s1;
+    const unsigned char *b = s2;
+
+    for (; n >= 16; n -= 16, a += 16, b += 16) {
+        unsigned int mask = MOVEMASK16(*(const v16qi_u *)a != *(const v16qi_u *)b);
+        if (mask) {
+            size_t i = __builtin_ctz(mask);
+            return a[i] - b[i];
+        }
+    }
+    return memcmp_bytes(a, b, n);
+}
+
+static int (*memcmp_impl)(const void *s1, const void *s2, size_t n) = NULL;
+
+int memcmp(const void *s1, const void *s2, size_t n) {
+    if (memcmp_impl == NULL) {
+        memcmp_impl = (cpu_features() & CPU_FEATURE_SSE2) ? memcmp_sse2 : memcmp_bytes;
+    }
+    return memcmp_impl(s1, s2, n);
+}
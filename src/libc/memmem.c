@@ -0,0 +1,91 @@
+/*
+ * memmem.c - Recherche d'une sous-chaîne dans une zone mémoire
+ * 
+ * Versions AVX2 / SSE2 (choisies au premier appel) et octet par octet.
+ * Les versions vectorielles comparent en parallèle le premier et le dernier
+ * octet de l'aiguille à 16 (ou 32) positions de départ consécutives; seules
+ * les positions où les deux correspondent sont vérifiées par memcmp.
+ * Les lectures restent dans la zone: la fin est traitée octet par octet.
+ * 
+ * Retour: adresse de la première occurrence, ou NULL
+ */
+
+#include "libc/libc.h"
+#include "libc/simd.h"
+
+static void *memmem_byte(const void *haystack, size_t hlen, const void *needle, size_t nlen) {
+    const unsigned char *h = haystack;
+    const unsigned char *n = needle;
+
+    if (nlen == 0) return (void *)h;
+
+    while (hlen >= nlen) {
+        const unsigned char *p = memchr(h, n[0], hlen - nlen + 1);
+        if (p == NULL) return NULL;
+        if (memcmp(p + 1, n + 1, nlen - 1) == 0) return (void *)p;
+
+        hlen -= (size_t)(p + 1 - h);
+        h = p + 1;
+    }
+    return NULL;
+}
+
+static void *memmem_sse2(const void *haystack, size_t hlen, const void *needle, size_t nlen) {
+    const char *h = haystack;
+    const char *n = needle;
+
+    if (nlen < 2 || nlen > hlen) return memmem_byte(haystack, hlen, needle, nlen);
+
+    v16qi first = SPLAT16(n[0]);
+    v16qi last = SPLAT16(n[nlen - 1]);
+    size_t i = 0;
+
+    for (; i + nlen - 1 + 16 <= hlen; i += 16) {
+        v16qi a = *(const v16qi_u *)(h + i);
+        v16qi b = *(const v16qi_u *)(h + i + nlen - 1);
+        unsigned int mask = MOVEMASK16((a == first) & (b == last));
+
+        while (mask) {
+            size_t j = i + __builtin_ctz(mask);
+            if (memcmp(h + j + 1, n + 1, nlen - 2) == 0) return (void *)(h + j);
+            mask &= mask - 1;
+        }
+    }
+    return memmem_byte(h + i, hlen - i, needle, nlen);
+}
+
+__attribute__((target("avx2")))
+static void *memmem_avx2(const void *haystack, size_t hlen, const void *needle, size_t nlen) {
+    const char *h = haystack;
+    const char *n = needle;
+
+    if (nlen < 2 || nlen > hlen) return memmem_byte(haystack, hlen, needle, nlen);
+
+    v32qi first = SPLAT32(n[0]);
+    v32qi last = SPLAT32(n[nlen - 1]);
+    size_t i = 0;
+
+    for (; i + nlen - 1 + 32 <= hlen; i += 32) {
+        v32qi a = *(const v32qi_u *)(h + i);
+        v32qi b = *(const v32qi_u *)(h + i + nlen - 1);
+        unsigned int mask = MOVEMASK32((a == first) & (b == last));
+
+        while (mask) {
+            size_t j = i + __builtin_ctz(mask);
+            if (memcmp(h + j + 1, n + 1, nlen - 2) == 0) return (void *)(h + j);
+            mask &= mask - 1;
+        }
+    }
+    return memmem_sse2(h + i, hlen - i, needle, nlen);
+}
+
+static void *(*memmem_impl)(const void *haystack, size_t hlen, const void *needle, size_t nlen) = NULL;
+
+void *memmem(const void *haystack, size_t hlen, const void *needle, size_t nlen) {
+    if (memmem_impl == NULL) {
+        unsigned int features = cpu_features();
+        memmem_impl = (features & CPU_FEATURE_AVX2) ? memmem_avx2
+                    : (features & CPU_FEATURE_SSE2) ? memmem_sse2 : memmem_byte;
+    }
+    return memmem_impl(haystack, hlen, needle, nlen);
+}
@@ -1,9 +1,78 @@
+/*
+ * memset.c - Remplissage d'une zone mémoire
+ * 
+ * Versions AVX2 / SSE2 (choisies au premier appel) et mots de 8 octets.
+ * Les zones vectorielles commencent et finissent par une écriture non
+ * alignée qui chevauche le corps aligné: pas de boucle octet par octet.
+ */
+
 #include "libc/libc.h"
+#include "libc/simd.h"
 
-void *memset(void *s, int c, size_t n) {
-    unsigned char *p = s;
+static void memset_bytes(unsigned char *p, unsigned char c, size_t n) {
     while (n--) {
+        *p++ = c;
+    }
+}
+
+static void *memset_word(void *s, int c, size_t n) {
+    unsigned char *p = s;
+    unsigned long long w = ONES64 * (unsigned char)c;
+
+    while (n > 0 && ((unsigned long)p & 7)) {
         *p++ = (unsigned char)c;
+        n--;
+    }
+    for (; n >= 8; n -= 8, p += 8) {
+        *(unsigned long long *)p = w;
+    }
+    memset_bytes(p, (unsigned char)c, n);
+    return s;
+}
+
+static void *memset_sse2(void *s, int c, size_t n) {
+    if (n < 16) {
+        memset_bytes(s, (unsigned char)c, n);
+        return s;
+    }
+
+    char *p = s;
+    char *end = p + n;
+    v16qi v = SPLAT16((char)c);
+
+    *(v16qi_u *)p = v;
+    for (p = (char *)(((unsigned long)p + 16) & ~15UL); p + 16 <= end; p += 16) {
+        *(v16qi *)p = v;
+    }
+    *(v16qi_u *)(end - 16) = v;
+    return s;
+}
+
+__attribute__((target("avx2")))
+static void *memset_avx2(void *s, int c, size_t n) {
+    if (n < 32) {
+        return memset_sse2(s, c, n);
+    }
+
+    char *p = s;
+    char *end = p + n;
+    v32qi v = SPLAT32((char)c);
+
+    *(v32qi_u *)p = v;
+    for (p = (char *)(((unsigned long)p + 32) & ~31UL); p + 32 <= end; p += 32) {
+        *(v32qi *)p = v;
     }
+    *(v32qi_u *)(end - 32) = v;
     return s;
-}
\ No newline at end of file
+}
+
+static void *(*memset_impl)(void *s, int c, size_t n) = NULL;
+
+void *memset(void *s, int c, size_t n) {
+    if (memset_impl == NULL) {
+        unsigned int features = cpu_features();
+        memset_impl = (features & CPU_FEATURE_AVX2) ? memset_avx2
+                    : (features & CPU_FEATURE_SSE2) ? memset_sse2 : memset_word;
+    }
+    return memset_impl(s, c, n);
+}
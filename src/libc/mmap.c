@@ -0,0 +1,46 @@
+/*
+ * mmap.c - Appel système mmap()
+ * 
+ * mmap() projette un fichier (ou de la mémoire anonyme) dans l'espace
+ * d'adressage du processus.
+ * Utilise le syscall 9 sur Linux x86_64.
+ * 
+ * Paramètres:
+ * - addr: adresse souhaitée (NULL = choisie par le noyau)
+ * - length: taille de la projection
+ * - prot: PROT_READ / PROT_WRITE
+ * - flags: MAP_SHARED / MAP_PRIVATE / MAP_ANONYMOUS / MAP_POPULATE
+ * - fd, offset: fichier et position projetés
+ * 
+ * Retour: adresse de la projection, ou MAP_FAILED en cas d'erreur
+ */
+
+#include "libc/libc.h"
+
+void *mmap(void *addr, size_t length, int prot, int flags, int fd, long offset) {
+    long ret;
+    register long flags_reg asm("r10") = flags;
+    register long fd_reg asm("r8") = fd;
+    register long offset_reg asm("r9") = offset;
+
+    __asm__ volatile (
+        "syscall"
+        : "=a" (ret)
+        : "a"(9L),
+          "D"(addr),
+          "S"(length),
+          "d"((long)prot),
+          "r"(flags_reg),
+          "r"(fd_reg),
+          "r"(offset_reg)
+        : "rcx", "r11", "memory"
+    );
+
+    STATS_SYSCALL(STAT_SYS_MMAP, ret);
+
+    // Le noyau retourne -errno (entre -4095 et -1) en cas d'échec
+    if (ret < 0 && ret > -4096) {
+        return MAP_FAILED;
+    }
+    return (void *)ret;
+}
@@ -0,0 +1,39 @@
+/*
+ * mremap.c - Appel système mremap()
+ * 
+ * mremap() agrandit ou réduit une projection existante, en la déplaçant
+ * si nécessaire (MREMAP_MAYMOVE) sans recopier les pages.
+ * Utilise le syscall 25 sur Linux x86_64.
+ * 
+ * Paramètres:
+ * - old_addr, old_size: projection actuelle
+ * - new_size: nouvelle taille
+ * - flags: MREMAP_MAYMOVE
+ * 
+ * Retour: adresse de la projection, ou MAP_FAILED en cas d'erreur
+ */
+
+#include "libc/libc.h"
+
+void *mremap(void *old_addr, size_t old_size, size_t new_size, int flags) {
+    long ret;
+    register long flags_reg asm("r10") = flags;
+
+    __asm__ volatile (
+        "syscall"
+        : "=a" (ret)
+        : "a"(25L),
+          "D"(old_addr),
+          "S"(old_size),
+          "d"(new_size),
+          "r"(flags_reg)
+        : "rcx", "r11", "memory"
+    );
+
+    STATS_SYSCALL(STAT_SYS_MREMAP, ret);
+
+    if (ret < 0 && ret > -4096) {
+        return MAP_FAILED;
+    }
+    return (void *)ret;
+}
@@ -0,0 +1,29 @@
+/*
+ * msync.c - Appel système msync()
+ * 
+ * msync() écrit sur disque les pages modifiées d'une projection MAP_SHARED.
+ * Utilise le syscall 26 sur Linux x86_64.
+ * 
+ * Paramètres:
+ * - addr, length: zone à synchroniser
+ * - flags: MS_SYNC (attend l'écriture) ou MS_ASYNC
+ * 
+ * Retour: 0 en cas de succès, valeur négative en cas d'erreur
+ */
+
+#include "libc/libc.h"
+
+int msync(void *addr, size_t length, int flags) {
+    long ret;
+    __asm__ volatile (
+        "syscall"
+        : "=a" (ret)
+        : "a"(26L),
+          "D"(addr),
+          "S"(length),
+          "d"((long)flags)
+        : "rcx", "r11", "memory"
+    );
+    STATS_SYSCALL(STAT_SYS_MSYNC, ret);
+    return (int)ret;
+}
@@ -0,0 +1,24 @@
+/*
+ * munmap.c - Appel système munmap()
+ * 
+ * munmap() supprime une projection créée par mmap().
+ * Utilise le syscall 11 sur Linux x86_64.
+ * 
+ * Retour: 0 en cas de succès, valeur négative en cas d'erreur
+ */
+
+#include "libc/libc.h"
+
+int munmap(void *addr, size_t length) {
+    long ret;
+    __asm__ volatile (
+        "syscall"
+        : "=a" (ret)
+        : "a"(11L),
+          "D"(addr),
+          "S"(length)
+        : "rcx", "r11", "memory"
+    );
+    STATS_SYSCALL(STAT_SYS_MUNMAP, ret);
+    return (int)ret;
+}
@@ -15,5 +15,6 @@ int open(const char *pathname, int flags, int mode) {
           "r"(mode_reg)
         : "rcx", "r11", "memory"
     );
+    STATS_SYSCALL(STAT_SYS_OPEN, ret);
     return ret;
 }
@@ -22,5 +22,6 @@ int pipe(int pipefd[2]) {
         : "D" (pipefd)
         :
     );
+    STATS_SYSCALL(STAT_SYS_PIPE, result);
     return result;
 }
\ No newline at end of file
@@ -0,0 +1,284 @@
+/*
+ * pool.c - Pool de threads partagé, à vol de tâches
+ *
+ * Un seul pool pour tout le processus, démarré au premier usage: un worker
+ * par CPU en plus du thread principal. Chaque thread a sa deque Chase-Lev:
+ * il empile et dépile ses tâches par le bas, les autres volent par le haut.
+ * Un worker sans travail se met en attente sur un futex (pool.epoch), que
+ * pool_submit() réveille.
+ *
+ * Les tâches ne sont jamais allouées par le pool: pool_task_t vit chez
+ * l'appelant (sur sa pile en général) jusqu'au retour de pool_wait(). Le
+ * thread courant est reconnu à l'adresse de sa pile. Comme pour
+ * thread_create(), une tâche ne doit appeler ni malloc() ni printf().
+ */
+
+#include "libc/libc.h"
+
+#define POOL_MAX_THREADS 16
+#define POOL_DEQUE_SIZE 1024   // puissance de 2
+#define POOL_DEQUE_MASK (POOL_DEQUE_SIZE - 1)
+
+// pool_group_t.pending: nombre de tâches (bits bas) | thread qui attend + 1 (bits hauts)
+#define POOL_WAITER_SHIFT 24
+#define POOL_COUNT_MASK ((1 << POOL_WAITER_SHIFT) - 1)
+
+typedef struct {
+    long top __attribute__((aligned(64)));      // avancé par les voleurs (CAS)
+    long bottom __attribute__((aligned(64)));   // modifié par le propriétaire seul
+    pool_task_t *tasks[POOL_DEQUE_SIZE];
+} pool_deque_t;
+
+static struct {
+    int started;
+    int n_threads;              // thread principal compris
+    int epoch;                  // futex des workers inactifs
+    int sleepers;
+    int wake[POOL_MAX_THREADS];   // futex de chaque thread en attente d'un groupe
+    thread_t workers[POOL_MAX_THREADS];
+    pool_deque_t deques[POOL_MAX_THREADS];   // 0 = thread principal
+} pool;
+
+// --- Deque Chase-Lev (Lê et al., "Correct and Efficient Work-Stealing for Weak Memory Models") ---
+
+// Propriétaire: empile en bas. Retour: -1 si la deque est pleine.
+static int deque_push(pool_deque_t *deque, pool_task_t *task) {
+    long bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED);
+    long top = __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+
+    if (bottom - top >= POOL_DEQUE_SIZE) return -1;
+    __atomic_store_n(&deque->tasks[bottom & POOL_DEQUE_MASK], task, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+    return 0;
+}
+
+// Propriétaire: dépile en bas (la dernière tâche se dispute avec les voleurs)
+static pool_task_t *deque_pop(pool_deque_t *deque) {
+    long bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED) - 1;
+    __atomic_store_n(&deque->bottom, bottom, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    long top = __atomic_load_n(&deque->top, __ATOMIC_RELAXED);
+
+    if (top > bottom) {
+        __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+
+    pool_task_t *task = __atomic_load_n(&deque->tasks[bottom & POOL_DEQUE_MASK], __ATOMIC_RELAXED);
+    if (top == bottom) {
+        if (!__atomic_compare_exchange_n(&deque->top, &top, top + 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+            task = NULL;
+        }
+        __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+    }
+    return task;
+}
+
+// Autres threads: volent en haut. Retour: NULL si vide ou vol perdu.
+static pool_task_t *deque_steal(pool_deque_t *deque) {
+    long top = __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    long bottom = __atomic_load_n(&deque->bottom, __ATOMIC_ACQUIRE);
+
+    if (top >= bottom) return NULL;
+
+    pool_task_t *task = __atomic_load_n(&deque->tasks[top & POOL_DEQUE_MASK], __ATOMIC_RELAXED);
+    if (!__atomic_compare_exchange_n(&deque->top, &top, top + 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+        return NULL;
+    }
+    return task;
+}
+
+// --- Ordonnancement ---
+
+// Indice du thread courant: le worker dont la pile contient la frame, sinon 0
+static int pool_self(void) {
+    char *frame = __builtin_frame_address(0);
+
+    for (int i = 1; i < pool.n_threads; i++) {
+        char *stack = pool.workers[i].stack;
+        if (frame >= stack && frame < stack + pool.workers[i].stack_size) return i;
+    }
+    return 0;
+}
+
+// Sa propre deque d'abord, puis vol chez les autres à tour de rôle
+static pool_task_t *pool_find_work(int self) {
+    pool_task_t *task = deque_pop(&pool.deques[self]);
+
+    for (int i = 1; task == NULL && i < pool.n_threads; i++) {
+        task = deque_steal(&pool.deques[(self + i) % pool.n_threads]);
+    }
+    return task;
+}
+
+/**
+ * Exécute une tâche et la décompte de son groupe. Dès que le compte atteint
+ * 0, pool_wait() peut retourner et le groupe disparaître (souvent sur la
+ * pile): le réveil passe donc par le futex du thread qui attend, dans
+ * `pool`, jamais par la mémoire du groupe.
+ */
+static void pool_run(pool_task_t *task) {
+    pool_group_t *group = task->group;
+
+    task->fn(task->arg);
+    int old = __atomic_fetch_sub(&group->pending, 1, __ATOMIC_ACQ_REL);
+    int waiter = old >> POOL_WAITER_SHIFT;
+    if ((old & POOL_COUNT_MASK) == 1 && waiter != 0) {
+        __atomic_add_fetch(&pool.wake[waiter - 1], 1, __ATOMIC_RELEASE);
+        futex_wake(&pool.wake[waiter - 1], 1);
+    }
+}
+
+static int pool_worker(void *arg) {
+    int self = (int)(long)arg;
+
+    for (;;) {
+        pool_task_t *task = pool_find_work(self);
+
+        if (task == NULL) {
+            // S'annonce inactif, puis revérifie: un pool_submit() concurrent voit sleepers > 0
+            int epoch = __atomic_load_n(&pool.epoch, __ATOMIC_ACQUIRE);
+            __atomic_add_fetch(&pool.sleepers, 1, __ATOMIC_SEQ_CST);
+            task = pool_find_work(self);
+            if (task == NULL) futex_wait(&pool.epoch, epoch);
+            __atomic_sub_fetch(&pool.sleepers, 1, __ATOMIC_SEQ_CST);
+        }
+        if (task != NULL) pool_run(task);
+    }
+    return 0;
+}
+
+// Démarre les workers (un par CPU en plus du thread principal)
+static void pool_start(void) {
+    int wanted = cpu_count();
+
+    if (wanted > POOL_MAX_THREADS) wanted = POOL_MAX_THREADS;
+    pool.started = 1;
+    pool.n_threads = 1;
+    while (pool.n_threads < wanted) {
+        int i = pool.n_threads;
+        if (thread_create(&pool.workers[i], pool_worker, (void *)(long)i) != 0) break;
+        // Publié après la création: un voleur ne voit que des deques de workers vivants
+        __atomic_store_n(&pool.n_threads, i + 1, __ATOMIC_RELEASE);
+    }
+}
+
+/**
+ * Dans l'enfant d'un fork() (appelé par fork()): seul le thread appelant a
+ * été copié, les workers n'existent plus. Le pool est remis à zéro et leurs
+ * piles rendues; il redémarrera au prochain usage. fork() ne doit pas être
+ * appelé pendant un pool_wait().
+ */
+void pool_after_fork(void) {
+    for (int i = 1; i < pool.n_threads; i++) {
+        munmap(pool.workers[i].stack, pool.workers[i].stack_size);
+    }
+    memset(&pool, 0, sizeof(pool));
+}
+
+/**
+ * Nombre de threads du pool, thread principal compris (démarre le pool).
+ */
+int pool_size(void) {
+    if (!pool.started) pool_start();
+    return pool.n_threads;
+}
+
+/**
+ * Confie fn(arg) au pool, comptée dans `group`. `task` appartient à
+ * l'appelant et doit rester valide jusqu'au retour de pool_wait(group).
+ * Si la deque est pleine, la tâche est exécutée tout de suite.
+ */
+void pool_submit(pool_group_t *group, pool_task_t *task, void (*fn)(void *), void *arg) {
+    if (!pool.started) pool_start();
+
+    task->fn = fn;
+    task->arg = arg;
+    task->group = group;
+    __atomic_add_fetch(&group->pending, 1, __ATOMIC_RELAXED);
+
+    if (deque_push(&pool.deques[pool_self()], task) != 0) {
+        pool_run(task);
+        return;
+    }
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&pool.sleepers, __ATOMIC_SEQ_CST) > 0) {
+        __atomic_add_fetch(&pool.epoch, 1, __ATOMIC_SEQ_CST);
+        futex_wake(&pool.epoch, 1);
+    }
+}
+
+/**
+ * Attend la fin des tâches de `group` en exécutant, en attendant, celles
+ * de sa deque ou volées aux autres threads.
+ */
+void pool_wait(pool_group_t *group) {
+    int self = pool_self();
+    int pending;
+
+    while (((pending = __atomic_load_n(&group->pending, __ATOMIC_ACQUIRE)) & POOL_COUNT_MASK) != 0) {
+        pool_task_t *task = pool_find_work(self);
+        if (task != NULL) {
+            pool_run(task);
+            continue;
+        }
+
+        // S'inscrit comme thread en attente tant que le compte n'a pas bougé,
+        // puis dort sur son propre futex (un réveil en trop ne fait que reboucler)
+        int seq = __atomic_load_n(&pool.wake[self], __ATOMIC_ACQUIRE);
+        int marked = (pending & POOL_COUNT_MASK) | ((self + 1) << POOL_WAITER_SHIFT);
+        if (__atomic_compare_exchange_n(&group->pending, &pending, marked, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+            futex_wait(&pool.wake[self], seq);
+        }
+    }
+}
+
+// --- parallel-for: découpage récursif en deux, la moitié droite offerte aux voleurs ---
+
+typedef struct {
+    void (*fn)(void *arg, size_t begin, size_t end);
+    void *arg;
+    size_t begin;
+    size_t end;
+    size_t grain;
+} pool_range_t;
+
+static void pool_range_run(void *arg) {
+    pool_range_t *range = arg;
+
+    if (range->end - range->begin <= range->grain) {
+        range->fn(range->arg, range->begin, range->end);
+        return;
+    }
+
+    pool_range_t left = *range;
+    pool_range_t right = *range;
+    pool_group_t group = { 0 };
+    pool_task_t task;
+
+    left.end = right.begin = range->begin + (range->end - range->begin) / 2;
+    pool_submit(&group, &task, pool_range_run, &right);
+    pool_range_run(&left);
+    pool_wait(&group);
+}
+
+/**
+ * Appelle fn(arg, b, e) sur des tranches disjointes couvrant [begin, end),
+ * de `grain` éléments au plus (sauf sans worker: une seule tranche), puis
+ * retourne quand toutes sont traitées.
+ */
+void pool_parallel_for(size_t begin, size_t end, size_t grain, void (*fn)(void *arg, size_t begin, size_t end), void *arg) {
+    if (begin >= end) return;
+    if (grain == 0) grain = 1;
+
+    if (end - begin <= grain || pool_size() == 1) {
+        fn(arg, begin, end);
+        return;
+    }
+
+    pool_range_t range = { fn, arg, begin, end, grain };
+    pool_range_run(&range);
+}
@@ -0,0 +1,35 @@
+/*
+ * pread.c - Appel système pread64()
+ * 
+ * pread() lit à une position donnée du fichier sans modifier
+ * l'offset courant du descripteur.
+ * Utilise le syscall 17 sur Linux x86_64.
+ * 
+ * Paramètres:
+ * - fd: descripteur de fichier
+ * - buf: buffer de destination
+ * - count: nombre d'octets à lire
+ * - offset: position de lecture dans le fichier
+ * 
+ * Retour: nombre d'octets lus, ou valeur négative en cas d'erreur
+ */
+
+#include "libc/libc.h"
+
+ssize_t pread(int fd, void *buf, size_t count, long offset) {
+    ssize_t ret;
+    register long offset_reg asm("r10") = offset;
+
+    __asm__ volatile (
+        "syscall"
+        : "=a" (ret)
+        : "a"(17L),
+          "D"((long)fd),
+          "S"(buf),
+          "d"(count),
+          "r"(offset_reg)
+        : "rcx", "r11", "memory"
+    );
+    STATS_SYSCALL(STAT_SYS_PREAD, ret);
+    return ret;
+}
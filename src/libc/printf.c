@@ -1,16 +1,12 @@
 #include "libc/libc.h"
 
-// Fonction helper pour écrire une chaîne
+// Fonction helper pour écrire une chaîne (copiée d'un bloc dans le tampon de stdout)
 static int write_string(const char *str) {
-    int count = 0;
     if (!str) str = "(null)";
     
-    while (*str) {
-        if (putchar(*str) < 0) return -1;
-        str++;
-        count++;
-    }
-    return count;
+    size_t len = strlen(str);
+    if (stdout_write(str, len) < 0) return -1;
+    return (int)len;
 }
 
 // Fonction helper pour compter les chiffres d'un nombre
@@ -168,12 +164,16 @@ int printf(const char *format, ...) {
                     break;
             }
         } else {
-            // Caractère normal
-            if (putchar(*ptr) < 0) {
+            // Texte littéral: tout le segment jusqu'au prochain '%' d'un coup
+            const char *end = ptr + 1;
+            while (*end && *end != '%') end++;
+            if (stdout_write(ptr, end - ptr) < 0) {
                 __builtin_va_end(args);
                 return -1;
             }
-            total_count++;
+            total_count += end - ptr;
+            ptr = end;
+            continue;
         }
         ptr++;
     }
@@ -1,6 +1,6 @@
 #include "libc/libc.h" 
 
 int putchar(char c) {
-    ssize_t ret = write(1, &c, 1);
+    ssize_t ret = stdout_write(&c, 1);
     return (ret == 1) ? (int)c : -1;
-}
\ No newline at end of file
+}
@@ -8,7 +8,7 @@ int puts(const char *str) {
     while (str[len]) len++;
     
     // Écrire la chaîne
-    if (write(1, str, len) < 0) return -1;
+    if (stdout_write(str, len) < 0) return -1;
     
     // Ajouter le '\n'
     if (putchar('\n') < 0) return -1;
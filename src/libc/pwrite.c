@@ -0,0 +1,35 @@
+/*
+ * pwrite.c - Appel système pwrite64()
+ * 
+ * pwrite() écrit à une position donnée du fichier sans modifier
+ * l'offset courant du descripteur.
+ * Utilise le syscall 18 sur Linux x86_64.
+ * 
+ * Paramètres:
+ * - fd: descripteur de fichier
+ * - buf: données à écrire
+ * - count: nombre d'octets à écrire
+ * - offset: position d'écriture dans le fichier
+ * 
+ * Retour: nombre d'octets écrits, ou valeur négative en cas d'erreur
+ */
+
+#include "libc/libc.h"
+
+ssize_t pwrite(int fd, const void *buf, size_t count, long offset) {
+    ssize_t ret;
+    register long offset_reg asm("r10") = offset;
+
+    __asm__ volatile (
+        "syscall"
+        : "=a" (ret)
+        : "a"(18L),
+          "D"((long)fd),
+          "S"(buf),
+          "d"(count),
+          "r"(offset_reg)
+        : "rcx", "r11", "memory"
+    );
+    STATS_SYSCALL(STAT_SYS_PWRITE, ret);
+    return ret;
+}
@@ -12,5 +12,6 @@ ssize_t read(int fd, void *buf, size_t count) {
           "d"(count)
         : "rcx", "r11", "memory"
     );
+    STATS_SYSCALL(STAT_SYS_READ, ret);
     return ret;
 }
\ No newline at end of file
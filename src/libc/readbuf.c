@@ -0,0 +1,85 @@
+/*
+ * readbuf.c - Lecture tamponnée par descripteur
+ * 
+ * readline() et getline() puisent dans un tampon propre à chaque fd au
+ * lieu de faire un appel système read() par caractère. Le tampon n'est
+ * rempli que lorsqu'il est vide, par un seul read() de READ_BUF_SIZE.
+ * 
+ * - read_buffered(): octets disponibles pour fd (remplit si besoin),
+ *   0 en fin de fichier, -1 en cas d'erreur ou sans emplacement libre
+ * - read_consume(): marque n octets comme lus
+ * - read_discard(): oublie le tampon de fd (appelé par close())
+ * 
+ * Le contenu consommé est effacé avant chaque remplissage: le tampon
+ * voit passer des mots de passe.
+ */
+
+#include "libc/libc.h"
+
+#define READ_BUF_SIZE 4096
+#define READ_BUF_SLOTS 4
+
+typedef struct {
+    int used;
+    int fd;
+    size_t pos;
+    size_t len;
+    char data[READ_BUF_SIZE];
+} read_buf_t;
+
+static read_buf_t read_bufs[READ_BUF_SLOTS];
+
+static read_buf_t *find_slot(int fd, int create) {
+    read_buf_t *free_slot = NULL;
+
+    for (int i = 0; i < READ_BUF_SLOTS; i++) {
+        if (read_bufs[i].used && read_bufs[i].fd == fd) {
+            return &read_bufs[i];
+        }
+        if (!read_bufs[i].used && free_slot == NULL) {
+            free_slot = &read_bufs[i];
+        }
+    }
+
+    if (!create || free_slot == NULL) {
+        return NULL;
+    }
+    free_slot->used = 1;
+    free_slot->fd = fd;
+    free_slot->pos = 0;
+    free_slot->len = 0;
+    return free_slot;
+}
+
+ssize_t read_buffered(int fd, const char **data) {
+    read_buf_t *rb = find_slot(fd, 1);
+    if (rb == NULL) return -1;
+
+    if (rb->pos == rb->len) {
+        memset(rb->data, 0, rb->len);
+        rb->pos = 0;
+        rb->len = 0;
+
+        ssize_t n = read(fd, rb->data, READ_BUF_SIZE);
+        if (n < 0) return -1;
+        rb->len = n;
+    }
+
+    *data = rb->data + rb->pos;
+    return rb->len - rb->pos;
+}
+
+void read_consume(int fd, size_t n) {
+    read_buf_t *rb = find_slot(fd, 0);
+    if (rb == NULL) return;
+
+    rb->pos += (n < rb->len - rb->pos) ? n : rb->len - rb->pos;
+}
+
+void read_discard(int fd) {
+    read_buf_t *rb = find_slot(fd, 0);
+    if (rb == NULL) return;
+
+    memset(rb->data, 0, rb->len);
+    rb->used = 0;
+}
@@ -1,16 +1,33 @@
 #include "libc/libc.h"
 
 ssize_t readline(char *buf, size_t size) {
-    ssize_t i = 0;
+    size_t i = 0;
+    stdout_flush(); // l'invite doit être visible avant de lire
+
     while (i < size - 1) {
-        ssize_t ret = read(0, &buf[i], 1);
-        if (ret <= 0) return -1;
-        if (buf[i] == '\n') {
-            buf[i] = '\0';
-            return i;
+        const char *data;
+        ssize_t avail = read_buffered(0, &data);
+        if (avail < 0) return -1;
+        if (avail == 0) break; // EOF
+
+        size_t take = size - 1 - i;
+        if ((size_t)avail < take) take = avail;
+
+        const char *nl = memchr(data, '\n', take);
+        if (nl != NULL) {
+            size_t len = nl - data;
+            memcpy(buf + i, data, len);
+            read_consume(0, len + 1);
+            buf[i + len] = '\0';
+            return i + len;
         }
-        i++;
+
+        memcpy(buf + i, data, take);
+        read_consume(0, take);
+        i += take;
     }
+
+    if (i == 0 && size > 1) return -1;
     buf[i] = '\0';
     return i;
-}
\ No newline at end of file
+}
@@ -3,54 +3,59 @@
  * 
  * Fonctionnement:
  * 1. Cas spéciaux: ptr=NULL → malloc(), size=0 → free()
- * 2. Si nouvelle taille ≤ taille actuelle: garde le bloc
- * 3. Sinon: alloue nouveau bloc, copie les données, libère l'ancien
+ * 2. Bloc projeté qui reste grand: mremap(), sans copie
+ * 3. Si nouvelle taille ≤ taille actuelle: découpe le bloc sur place
+ * 4. Si le bloc suivant est libre ou que le bloc est en haut du heap:
+ *    l'agrandit sur place
+ * 5. Sinon: alloue nouveau bloc, copie les données, libère l'ancien
  */
 
 #include "libc/libc.h"
 
-static block_header_t *get_header(void *ptr) {
-    return (block_header_t *)((char *)ptr - sizeof(block_header_t));
-}
-
-static void copy_data(void *dest, const void *src, size_t size) {
-    char *d = (char *)dest;
-    const char *s = (const char *)src;
-    for (size_t i = 0; i < size; i++) {
-        d[i] = s[i];
-    }
-}
-
 void *realloc(void *ptr, size_t size) {
-    if (ptr == (void *)0) {
+    if (ptr == NULL) {
         return malloc(size);
     }
     
     if (size == 0) {
         free(ptr);
-        return (void *)0;
+        return NULL;
     }
     
-    size_t aligned_size = ALIGN(size);
-    block_header_t *header = get_header(ptr);
-    size_t current_size = GET_SIZE(header);
+    block_header_t *header = DATA_BLOCK(ptr);
+    size_t usable;
     
     if (IS_FREE(header)) {
-        return (void *)0;
+        return NULL;
     }
     
-    if (current_size >= aligned_size) {
-        return ptr;
+    if (IS_MMAPPED(header)) {
+        if (size >= MMAP_THRESHOLD) {
+            return heap_mmap_resize(header, size);
+        }
+        usable = GET_SIZE(header) - 2 * sizeof(block_header_t);
+    } else {
+        if (size < MMAP_THRESHOLD) {
+            size_t block_size = BLOCK_SIZE_FOR(size);
+            
+            if (GET_SIZE(header) >= block_size) {
+                heap_split(header, block_size);
+                return ptr;
+            }
+            if (heap_extend(header, block_size) == 0) {
+                return ptr;
+            }
+        }
+        usable = GET_SIZE(header) - sizeof(block_header_t);
     }
     
     void *new_ptr = malloc(size);
-    if (new_ptr == (void *)0) {
-        return (void *)0;
+    if (new_ptr == NULL) {
+        return NULL;
     }
     
-    size_t copy_size = (current_size < aligned_size) ? current_size : aligned_size;
-    copy_data(new_ptr, ptr, copy_size);
+    memcpy(new_ptr, ptr, (usable < size) ? usable : size);
     
     free(ptr);
     return new_ptr;
-}
\ No newline at end of file
+}
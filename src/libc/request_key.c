@@ -0,0 +1,35 @@
+/*
+ * request_key.c - Appel système request_key()
+ * 
+ * request_key() cherche une clé dans les trousseaux du processus
+ * (thread, processus, session). Sans callout_info, le noyau ne tente
+ * pas de la construire: elle existe ou l'appel échoue (-ENOKEY).
+ * Utilise le syscall 249 sur Linux x86_64.
+ * 
+ * Paramètres:
+ * - type: type de clé ("user")
+ * - description: nom de la clé
+ * - callout_info: donnée pour /sbin/request-key, ou NULL
+ * - dest_keyring: trousseau où lier la clé trouvée, ou 0
+ * 
+ * Retour: numéro de série de la clé, valeur négative en cas d'erreur
+ */
+
+#include "libc/libc.h"
+
+int request_key(const char *type, const char *description, const char *callout_info, int dest_keyring) {
+    long ret;
+    register long dest_reg asm("r10") = dest_keyring;
+    __asm__ volatile (
+        "syscall"
+        : "=a" (ret)
+        : "a"(249L),
+          "D"(type),
+          "S"(description),
+          "d"(callout_info),
+          "r"(dest_reg)
+        : "rcx", "r11", "memory"
+    );
+    STATS_SYSCALL(STAT_SYS_REQUEST_KEY, ret);
+    return (int)ret;
+}
@@ -0,0 +1,32 @@
+/*
+ * sched_getaffinity.c - Appel système sched_getaffinity()
+ * 
+ * sched_getaffinity() lit le masque des CPU sur lesquels un thread
+ * peut s'exécuter.
+ * Utilise le syscall 204 sur Linux x86_64.
+ * 
+ * Paramètres:
+ * - pid: thread visé (0 pour l'appelant)
+ * - size: taille du masque en octets
+ * - mask: reçoit un bit par CPU
+ * 
+ * Retour: nombre d'octets écrits dans mask, valeur négative en cas d'erreur
+ */
+
+#include "libc/libc.h"
+
+int sched_getaffinity(int pid, size_t size, void *mask) {
+    long ret;
+
+    __asm__ volatile (
+        "syscall"
+        : "=a" (ret)
+        : "a"(204L),
+          "D"((long)pid),
+          "S"(size),
+          "d"(mask)
+        : "rcx", "r11", "memory"
+    );
+    STATS_SYSCALL(STAT_SYS_SCHED_GETAFFINITY, ret);
+    return (int)ret;
+}
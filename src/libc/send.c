@@ -0,0 +1,38 @@
+/*
+ * send.c - Appel système sendto() sans adresse
+ * 
+ * send() écrit sur une socket connectée. Avec MSG_NOSIGNAL, un pair
+ * déconnecté donne une erreur au lieu d'un signal SIGPIPE fatal.
+ * Utilise le syscall 44 (sendto) sur Linux x86_64.
+ * 
+ * Paramètres:
+ * - sockfd: socket connectée
+ * - buf, len: données à écrire
+ * - flags: MSG_NOSIGNAL
+ * 
+ * Retour: nombre d'octets écrits, valeur négative en cas d'erreur
+ */
+
+#include "libc/libc.h"
+
+ssize_t send(int sockfd, const void *buf, size_t len, int flags) {
+    ssize_t ret;
+    register long flags_reg asm("r10") = flags;
+    register long addr_reg asm("r8") = 0;
+    register long addrlen_reg asm("r9") = 0;
+
+    __asm__ volatile (
+        "syscall"
+        : "=a" (ret)
+        : "a"(44L),
+          "D"((long)sockfd),
+          "S"(buf),
+          "d"(len),
+          "r"(flags_reg),
+          "r"(addr_reg),
+          "r"(addrlen_reg)
+        : "rcx", "r11", "memory"
+    );
+    STATS_SYSCALL(STAT_SYS_SEND, ret);
+    return ret;
+}
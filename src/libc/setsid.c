@@ -0,0 +1,22 @@
+/*
+ * setsid.c - Appel système setsid()
+ * 
+ * setsid() crée une nouvelle session, détachée du terminal.
+ * Utilise le syscall 112 sur Linux x86_64.
+ * 
+ * Retour: identifiant de la session, valeur négative en cas d'erreur
+ */
+
+#include "libc/libc.h"
+
+int setsid(void) {
+    long ret;
+    __asm__ volatile (
+        "syscall"
+        : "=a" (ret)
+        : "a"(112L)
+        : "rcx", "r11", "memory"
+    );
+    STATS_SYSCALL(STAT_SYS_SETSID, ret);
+    return (int)ret;
+}
@@ -0,0 +1,30 @@
+/*
+ * socket.c - Appel système socket()
+ * 
+ * socket() crée une extrémité de communication.
+ * Utilise le syscall 41 sur Linux x86_64.
+ * 
+ * Paramètres:
+ * - domain: AF_UNIX
+ * - type: SOCK_STREAM, éventuellement | SOCK_NONBLOCK / SOCK_CLOEXEC
+ * - protocol: 0
+ * 
+ * Retour: descripteur de la socket, valeur négative en cas d'erreur
+ */
+
+#include "libc/libc.h"
+
+int socket(int domain, int type, int protocol) {
+    long ret;
+    __asm__ volatile (
+        "syscall"
+        : "=a" (ret)
+        : "a"(41L),
+          "D"((long)domain),
+          "S"((long)type),
+          "d"((long)protocol)
+        : "rcx", "r11", "memory"
+    );
+    STATS_SYSCALL(STAT_SYS_SOCKET, ret);
+    return (int)ret;
+}
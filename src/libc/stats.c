@@ -0,0 +1,187 @@
+/*
+ * stats.c - Statistiques d'exécution (make STATS=1)
+ *
+ * Les wrappers de syscalls comptent leurs appels, leurs échecs (-errno)
+ * et les octets lus ou écrits; STATS_BEGIN/STATS_END cumulent la durée de
+ * phases nommées. L'horloge n'est lue, et le rapport écrit sur stderr,
+ * qu'après stats_enable() (--stats ou PWMAN_STATS=1).
+ * clock_gettime() n'est pas comptée: ce sont les mesures elles-mêmes.
+ *
+ * Sans PWMAN_STATS, ce fichier est vide.
+ */
+
+#include "libc/libc.h"
+
+#ifdef PWMAN_STATS
+
+#define STATS_MAX_PHASES 32
+#define STATS_LINE_MAX 128
+
+static const char *const syscall_names[STAT_SYS_COUNT] = {
+    "read", "pread", "write", "pwrite", "send",
+    "open", "close", "lseek", "ftruncate", "unlink",
+    "brk", "mmap", "munmap", "mremap", "msync",
+    "fork", "execve", "waitpid", "getpid", "pipe",
+    "dup2", "setsid", "umask",
+    "socket", "bind", "listen", "accept4", "connect",
+    "epoll_create1", "epoll_ctl", "epoll_wait",
+    "add_key", "request_key", "keyctl",
+    "clone", "futex", "sched_getaffinity",
+    "ioctl",
+};
+
+typedef struct {
+    const char *name;
+    unsigned long long ns;
+    unsigned long long count;
+} stats_phase_t;
+
+static int stats_on = 0;
+static unsigned long long calls[STAT_SYS_COUNT];
+static unsigned long long errors[STAT_SYS_COUNT];
+static unsigned long long bytes_read = 0;
+static unsigned long long bytes_written = 0;
+static stats_phase_t phases[STATS_MAX_PHASES];
+static int phase_count = 0;
+
+void stats_enable(void) {
+    stats_on = 1;
+}
+
+// Compteurs atomiques: les workers du pool font aussi des syscalls (futex)
+void stats_syscall(int sys, long ret) {
+    __atomic_add_fetch(&calls[sys], 1, __ATOMIC_RELAXED);
+    if (ret < 0 && ret > -4096) {
+        __atomic_add_fetch(&errors[sys], 1, __ATOMIC_RELAXED);
+    } else if (sys == STAT_SYS_READ || sys == STAT_SYS_PREAD) {
+        __atomic_add_fetch(&bytes_read, (unsigned long long)ret, __ATOMIC_RELAXED);
+    } else if (sys == STAT_SYS_WRITE || sys == STAT_SYS_PWRITE || sys == STAT_SYS_SEND) {
+        __atomic_add_fetch(&bytes_written, (unsigned long long)ret, __ATOMIC_RELAXED);
+    }
+}
+
+// Horodatage en nanosecondes, 0 si les statistiques ne sont pas demandées
+unsigned long long stats_now(void) {
+    struct timespec ts;
+
+    if (!stats_on) return 0;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+}
+
+// Ajoute la durée écoulée depuis start à la phase `name` (créée au premier appel)
+void stats_phase(const char *name, unsigned long long start) {
+    if (!stats_on) return;
+
+    unsigned long long elapsed = stats_now() - start;
+    int i = 0;
+    while (i < phase_count && strcmp(phases[i].name, name) != 0) i++;
+    if (i == phase_count) {
+        if (phase_count == STATS_MAX_PHASES) return;
+        phases[phase_count].name = name;
+        phases[phase_count].ns = 0;
+        phases[phase_count].count = 0;
+        phase_count++;
+    }
+    phases[i].ns += elapsed;
+    phases[i].count++;
+}
+
+// --- Rapport: lignes construites dans un tampon puis écrites d'un bloc sur stderr ---
+
+typedef struct {
+    char buf[STATS_LINE_MAX];
+    size_t len;
+} stats_line_t;
+
+static void line_str(stats_line_t *line, const char *s) {
+    while (*s && line->len < STATS_LINE_MAX - 1) line->buf[line->len++] = *s++;
+}
+
+static void line_pad(stats_line_t *line, size_t column) {
+    while (line->len < column && line->len < STATS_LINE_MAX - 1) line->buf[line->len++] = ' ';
+}
+
+static void line_u64(stats_line_t *line, unsigned long long value) {
+    char tmp[24];
+    int n = 0;
+
+    do {
+        tmp[n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    while (n > 0 && line->len < STATS_LINE_MAX - 1) line->buf[line->len++] = tmp[--n];
+}
+
+// Durée en millisecondes, 3 décimales
+static void line_ms(stats_line_t *line, unsigned long long ns) {
+    unsigned long long us = ns / 1000;
+
+    line_u64(line, us / 1000);
+    line_str(line, ".");
+    line_str(line, (us % 1000 < 100) ? ((us % 1000 < 10) ? "00" : "0") : "");
+    line_u64(line, us % 1000);
+    line_str(line, " ms");
+}
+
+static void line_flush(stats_line_t *line) {
+    line->buf[line->len++] = '\n';
+    write(2, line->buf, line->len);
+    line->len = 0;
+}
+
+/**
+ * Écrit sur stderr les phases (durée cumulée, nombre de passages), les
+ * syscalls appelés au moins une fois et le total des octets lus et écrits.
+ */
+void stats_report(void) {
+    stats_line_t line;
+    unsigned long long sys_calls[STAT_SYS_COUNT];
+    unsigned long long total_read = bytes_read, total_written = bytes_written;
+
+    if (!stats_on) return;
+    line.len = 0;
+
+    // Les écritures du rapport lui-même ne sont pas comptées
+    memcpy(sys_calls, calls, sizeof(sys_calls));
+
+    line_str(&line, "--- pwman stats ---");
+    line_flush(&line);
+
+    for (int i = 0; i < phase_count; i++) {
+        line_str(&line, "phase    ");
+        line_str(&line, phases[i].name);
+        line_pad(&line, 32);
+        line_ms(&line, phases[i].ns);
+        line_pad(&line, 48);
+        line_str(&line, "x");
+        line_u64(&line, phases[i].count);
+        line_flush(&line);
+    }
+
+    for (int sys = 0; sys < STAT_SYS_COUNT; sys++) {
+        if (sys_calls[sys] == 0) continue;
+        line_str(&line, "syscall  ");
+        line_str(&line, syscall_names[sys]);
+        line_pad(&line, 32);
+        line_u64(&line, sys_calls[sys]);
+        line_str(&line, " calls");
+        if (errors[sys] > 0) {
+            line_pad(&line, 48);
+            line_u64(&line, errors[sys]);
+            line_str(&line, " failed");
+        }
+        line_flush(&line);
+    }
+
+    line_str(&line, "bytes    read");
+    line_pad(&line, 32);
+    line_u64(&line, total_read);
+    line_flush(&line);
+    line_str(&line, "bytes    written");
+    line_pad(&line, 32);
+    line_u64(&line, total_written);
+    line_flush(&line);
+}
+
+#endif
@@ -0,0 +1,51 @@
+/*
+ * stdout.c - Sortie standard tamponnée
+ * 
+ * putchar(), puts() et printf() écrivent dans un tampon au lieu de faire
+ * un appel système write() par caractère. Le tampon est vidé:
+ * - quand il est plein,
+ * - explicitement par stdout_flush(),
+ * - avant une lecture sur l'entrée standard (readline, getline sur fd 0),
+ * - à la sortie du programme (exit(), appelé aussi par crt0 après main).
+ * 
+ * Le contenu vidé est effacé: le tampon voit passer des mots de passe.
+ */
+
+#include "libc/libc.h"
+
+#define STDOUT_BUF_SIZE 65536
+
+static char stdout_buf[STDOUT_BUF_SIZE];
+static size_t stdout_len = 0;
+
+static int write_all(const char *buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(1, buf, len);
+        if (n <= 0) return -1;
+        buf += n;
+        len -= n;
+    }
+    return 0;
+}
+
+int stdout_flush(void) {
+    int ret = write_all(stdout_buf, stdout_len);
+    memset(stdout_buf, 0, stdout_len);
+    stdout_len = 0;
+    return ret;
+}
+
+ssize_t stdout_write(const void *buf, size_t count) {
+    if (stdout_len + count > STDOUT_BUF_SIZE) {
+        if (stdout_flush() < 0) return -1;
+    }
+
+    // Un bloc plus grand que le tampon est écrit directement
+    if (count >= STDOUT_BUF_SIZE) {
+        return (write_all(buf, count) < 0) ? -1 : (ssize_t)count;
+    }
+
+    memcpy(stdout_buf + stdout_len, buf, count);
+    stdout_len += count;
+    return count;
+}
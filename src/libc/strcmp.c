@@ -1,12 +1,53 @@
-#include "libc/libc.h" 
+/*
+ * strcmp.c - Comparaison de deux chaînes
+ * 
+ * Version SSE2: 16 octets par comparaison, en cherchant à la fois la
+ * première différence et la fin de chaîne. Une lecture non alignée qui
+ * traverserait une page est remplacée par un pas octet par octet.
+ */
 
-int strcmp(const char *s1, const char *s2) {
-    if (!s1 || !s2) return (s1 == s2) ? 0 : (s1 ? 1 : -1);
-    
+#include "libc/libc.h"
+#include "libc/simd.h"
+
+static int strcmp_bytes(const char *s1, const char *s2) {
     while (*s1 && (*s1 == *s2)) {
         s1++;
         s2++;
     }
     
     return (unsigned char)*s1 - (unsigned char)*s2;
-}
\ No newline at end of file
+}
+
+static int strcmp_sse2(const char *s1, const char *s2) {
+    for (;;) {
+        if (PAGE_CROSSES(s1, 16) || PAGE_CROSSES(s2, 16)) {
+            if (*s1 == '\0' || *s1 != *s2) {
+                return (unsigned char)*s1 - (unsigned char)*s2;
+            }
+            s1++;
+            s2++;
+            continue;
+        }
+
+        v16qi a = *(const v16qi_u *)s1;
+        v16qi b = *(const v16qi_u *)s2;
+        unsigned int mask = MOVEMASK16((a != b) | (a == SPLAT16(0)));
+        if (mask) {
+            size_t i = __builtin_ctz(mask);
+            return (unsigned char)s1[i] - (unsigned char)s2[i];
+        }
+        s1 += 16;
+        s2 += 16;
+    }
+}
+
+static int (*strcmp_impl)(const char *s1, const char *s2) = NULL;
+
+int strcmp(const char *s1, const char *s2) {
+    if (!s1 || !s2) return (s1 == s2) ? 0 : (s1 ? 1 : -1);
+    
+    if (strcmp_impl == NULL) {
+        strcmp_impl = (cpu_features() & CPU_FEATURE_SSE2) ? strcmp_sse2 : strcmp_bytes;
+    }
+    return strcmp_impl(s1, s2);
+}
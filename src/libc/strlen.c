@@ -1,9 +1,71 @@
+/*
+ * strlen.c - Longueur d'une chaîne
+ * 
+ * Trois versions, choisies au premier appel selon cpu_features():
+ * - AVX2: 32 octets par lecture alignée
+ * - SSE2: 16 octets par lecture alignée
+ * - sinon: mots de 8 octets alignés
+ * 
+ * Les lectures alignées commencent avant s: les octets qui précèdent s sont
+ * ignorés par décalage du masque (voir simd.h pour la sûreté en fin de page).
+ */
+
 #include "libc/libc.h"
+#include "libc/simd.h"
+
+static size_t strlen_word(const char *s) {
+    size_t off = (unsigned long)s & 7;
+    const unsigned long long *p = (const unsigned long long *)(s - off);
+
+    // Octets avant s forcés à 0xff pour ne pas les prendre pour la fin
+    unsigned long long w = *p | ((1ULL << (off * 8)) - 1);
+    while (!HAS_ZERO64(w)) {
+        w = *++p;
+    }
+
+    const char *c = ((const char *)p < s) ? s : (const char *)p;
+    while (*c) c++;
+    return c - s;
+}
+
+static size_t strlen_sse2(const char *s) {
+    size_t off = (unsigned long)s & 15;
+    const v16qi *p = (const v16qi *)(s - off);
+
+    unsigned int mask = MOVEMASK16(*p == SPLAT16(0)) >> off;
+    if (mask) return __builtin_ctz(mask);
+
+    for (;;) {
+        p++;
+        mask = MOVEMASK16(*p == SPLAT16(0));
+        if (mask) return (const char *)p - s + __builtin_ctz(mask);
+    }
+}
+
+__attribute__((target("avx2")))
+static size_t strlen_avx2(const char *s) {
+    size_t off = (unsigned long)s & 31;
+    const v32qi *p = (const v32qi *)(s - off);
+
+    unsigned int mask = MOVEMASK32(*p == SPLAT32(0)) >> off;
+    if (mask) return __builtin_ctz(mask);
+
+    for (;;) {
+        p++;
+        mask = MOVEMASK32(*p == SPLAT32(0));
+        if (mask) return (const char *)p - s + __builtin_ctz(mask);
+    }
+}
+
+static size_t (*strlen_impl)(const char *s) = NULL;
 
 size_t strlen(const char *s) {
-    size_t i = 0;
-    while (s && s[i]) {
-        i++;
+    if (!s) return 0;
+
+    if (strlen_impl == NULL) {
+        unsigned int features = cpu_features();
+        strlen_impl = (features & CPU_FEATURE_AVX2) ? strlen_avx2
+                    : (features & CPU_FEATURE_SSE2) ? strlen_sse2 : strlen_word;
     }
-    return i;
-}
\ No newline at end of file
+    return strlen_impl(s);
+}
@@ -1,11 +1,14 @@
-#include "libc/libc.h" 
+/*
+ * strncmp.c - Comparaison d'au plus n caractères
+ * 
+ * Même principe que strcmp.c: 16 octets par comparaison SSE2 tant qu'il
+ * reste au moins 16 caractères et que la lecture ne traverse pas de page.
+ */
 
-int strncmp(const char *s1, const char *s2, size_t n) {
-    if (!s1 || !s2 || n == 0) {
-        if (n == 0) return 0;
-        return (s1 == s2) ? 0 : (s1 ? 1 : -1);
-    }
-    
+#include "libc/libc.h"
+#include "libc/simd.h"
+
+static int strncmp_bytes(const char *s1, const char *s2, size_t n) {
     while (n > 0 && *s1 && (*s1 == *s2)) {
         s1++;
         s2++;
@@ -14,4 +17,47 @@ int strncmp(const char *s1, const char *s2, size_t n) {
     
     if (n == 0) return 0;
     return (unsigned char)*s1 - (unsigned char)*s2;
-}
\ No newline at end of file
+}
+
+static int strncmp_sse2(const char *s1, const char *s2, size_t n) {
+    while (n >= 16 && !PAGE_CROSSES(s1, 16) && !PAGE_CROSSES(s2, 16)) {
+        v16qi a = *(const v16qi_u *)s1;
+        v16qi b = *(const v16qi_u *)s2;
+        unsigned int mask = MOVEMASK16((a != b) | (a == SPLAT16(0)));
+        if (mask) {
+            size_t i = __builtin_ctz(mask);
+            return (unsigned char)s1[i] - (unsigned char)s2[i];
+        }
+        s1 += 16;
+        s2 += 16;
+        n -= 16;
+    }
+
+    // Reste, ou pas octet par octet jusqu'à la page suivante
+    while (n > 0) {
+        if (*s1 == '\0' || *s1 != *s2) {
+            return (unsigned char)*s1 - (unsigned char)*s2;
+        }
+        s1++;
+        s2++;
+        n--;
+        if (n >= 16 && !PAGE_CROSSES(s1, 16) && !PAGE_CROSSES(s2, 16)) {
+            return strncmp_sse2(s1, s2, n);
+        }
+    }
+    return 0;
+}
+
+static int (*strncmp_impl)(const char *s1, const char *s2, size_t n) = NULL;
+
+int strncmp(const char *s1, const char *s2, size_t n) {
+    if (!s1 || !s2 || n == 0) {
+        if (n == 0) return 0;
+        return (s1 == s2) ? 0 : (s1 ? 1 : -1);
+    }
+    
+    if (strncmp_impl == NULL) {
+        strncmp_impl = (cpu_features() & CPU_FEATURE_SSE2) ? strncmp_sse2 : strncmp_bytes;
+    }
+    return strncmp_impl(s1, s2, n);
+}
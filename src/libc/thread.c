@@ -0,0 +1,78 @@
+/*
+ * thread.c - Threads minimaux sur clone() et futex()
+ * 
+ * Chaque thread a sa propre pile (mmap). Le noyau écrit le TID dans
+ * thread->tid avant le retour de clone() (CLONE_PARENT_SETTID), puis le
+ * remet à 0 et réveille ses attentes futex quand le thread se termine
+ * (CLONE_CHILD_CLEARTID): thread_join() attend que ce mot passe à 0.
+ * 
+ * Les threads partagent tout le processus, sans verrou dans la libc: la
+ * fonction d'un thread ne doit appeler ni malloc() ni printf().
+ */
+
+#include "libc/libc.h"
+
+#define THREAD_STACK_SIZE (256 * 1024)
+#define THREAD_CLONE_FLAGS (CLONE_VM | CLONE_FS | CLONE_FILES | CLONE_SIGHAND | CLONE_THREAD \
+                            | CLONE_SYSVSEM | CLONE_PARENT_SETTID | CLONE_CHILD_CLEARTID)
+#define CPU_MASK_BYTES 128   // jusqu'à 1024 CPU
+
+/**
+ * Attend que *addr ne vaille plus `expected` (réveil par futex_wake).
+ * Le mot peut être partagé avec le noyau (CLONE_CHILD_CLEARTID): pas de
+ * FUTEX_PRIVATE_FLAG.
+ */
+void futex_wait(int *addr, int expected) {
+    while (__atomic_load_n(addr, __ATOMIC_ACQUIRE) == expected) {
+        futex(addr, FUTEX_WAIT, expected, NULL);
+    }
+}
+
+// Réveille jusqu'à `count` threads en attente sur addr
+void futex_wake(int *addr, int count) {
+    futex(addr, FUTEX_WAKE, count, NULL);
+}
+
+/**
+ * Lance fn(arg) dans un nouveau thread.
+ * Retour: 0, ou -1 si la pile ou le thread n'ont pas pu être créés.
+ */
+int thread_create(thread_t *thread, int (*fn)(void *), void *arg) {
+    thread->stack = mmap(NULL, THREAD_STACK_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (thread->stack == MAP_FAILED) return -1;
+    thread->stack_size = THREAD_STACK_SIZE;
+    thread->tid = 0;
+
+    int tid = clone(fn, arg, (char *)thread->stack + THREAD_STACK_SIZE, THREAD_CLONE_FLAGS,
+                    &thread->tid, &thread->tid);
+    if (tid < 0) {
+        munmap(thread->stack, thread->stack_size);
+        return -1;
+    }
+    return 0;
+}
+
+// Attend la fin du thread puis libère sa pile
+void thread_join(thread_t *thread) {
+    int tid;
+
+    while ((tid = __atomic_load_n(&thread->tid, __ATOMIC_ACQUIRE)) != 0) {
+        futex_wait(&thread->tid, tid);
+    }
+    munmap(thread->stack, thread->stack_size);
+}
+
+/**
+ * Nombre de CPU utilisables par le processus (masque d'affinité),
+ * au moins 1.
+ */
+int cpu_count(void) {
+    unsigned char mask[CPU_MASK_BYTES];
+    int count = 0;
+
+    int n = sched_getaffinity(0, sizeof(mask), mask);
+    for (int i = 0; i < n; i++) {
+        for (unsigned int bits = mask[i]; bits != 0; bits &= bits - 1) count++;
+    }
+    return count > 0 ? count : 1;
+}
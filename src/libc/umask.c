@@ -0,0 +1,26 @@
+/*
+ * umask.c - Appel système umask()
+ * 
+ * umask() fixe le masque des permissions des fichiers créés.
+ * Utilise le syscall 95 sur Linux x86_64.
+ * 
+ * Paramètres:
+ * - mask: bits de permission à retirer (ex. 077)
+ * 
+ * Retour: ancien masque
+ */
+
+#include "libc/libc.h"
+
+int umask(int mask) {
+    long ret;
+    __asm__ volatile (
+        "syscall"
+        : "=a" (ret)
+        : "a"(95L),
+          "D"((long)mask)
+        : "rcx", "r11", "memory"
+    );
+    STATS_SYSCALL(STAT_SYS_UMASK, ret);
+    return (int)ret;
+}
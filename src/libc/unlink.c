@@ -0,0 +1,26 @@
+/*
+ * unlink.c - Appel système unlink()
+ * 
+ * unlink() supprime un nom du système de fichiers.
+ * Utilise le syscall 87 sur Linux x86_64.
+ * 
+ * Paramètres:
+ * - pathname: chemin à supprimer
+ * 
+ * Retour: 0 en cas de succès, valeur négative en cas d'erreur
+ */
+
+#include "libc/libc.h"
+
+int unlink(const char *pathname) {
+    long ret;
+    __asm__ volatile (
+        "syscall"
+        : "=a" (ret)
+        : "a"(87L),
+          "D"(pathname)
+        : "rcx", "r11", "memory"
+    );
+    STATS_SYSCALL(STAT_SYS_UNLINK, ret);
+    return (int)ret;
+}
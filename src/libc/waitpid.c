@@ -23,5 +23,6 @@ int waitpid(int pid, int *status, int options) {
         : "D" (pid), "S" (status), "d" (options)
         :
     );
+    STATS_SYSCALL(STAT_SYS_WAITPID, result);
     return result;
 }
\ No newline at end of file
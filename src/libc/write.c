@@ -12,5 +12,6 @@ ssize_t write(int fd, const void *buf, size_t count) {
           "d"(count)
         : "rcx", "r11", "memory"
     );
+    STATS_SYSCALL(STAT_SYS_WRITE, ret);
     return ret;
 }
@@ -0,0 +1,148 @@
+#include "pwman.h"
+
+/*
+ * Compresseur LZ77 minimal, format proche de LZ4 (séquences indépendantes
+ * de toute bibliothèque). Chaque séquence:
+ *   token: 4 bits de littéraux | 4 bits de (longueur de copie - LZ_MIN_MATCH)
+ *   [octets de longueur supplémentaires si un champ vaut 15: 255 tant que ça continue]
+ *   littéraux
+ *   distance de la copie sur 2 octets (little-endian), puis longueur supplémentaire
+ * La dernière séquence n'a que des littéraux: l'entrée s'arrête juste après.
+ * Les copies sont trouvées par une table de hachage sur 4 octets (une seule
+ * position candidate par case), ce qui suffit pour des champs très répétitifs.
+ */
+
+#define LZ_HASH_BITS 12
+#define LZ_MIN_MATCH 4
+#define LZ_MAX_OFFSET 65535
+#define LZ_RUN_MASK 15
+
+static uint32_t lz_hash(const uint8_t *p) {
+    uint32_t v = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    return (v * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+// Écrit la suite d'une longueur >= 15 (octets de 255 puis le reste)
+static uint8_t *lz_put_len(uint8_t *op, const uint8_t *oend, size_t len) {
+    while (len >= 255) {
+        if (op >= oend) return NULL;
+        *op++ = 255;
+        len -= 255;
+    }
+    if (op >= oend) return NULL;
+    *op++ = (uint8_t)len;
+    return op;
+}
+
+// Lit la suite d'une longueur; retourne -1 si l'entrée est tronquée
+static int lz_get_len(const uint8_t **ip, const uint8_t *iend, size_t *len) {
+    uint8_t byte;
+    do {
+        if (*ip >= iend || *len > ((size_t)1 << 30)) return -1;
+        byte = *(*ip)++;
+        *len += byte;
+    } while (byte == 255);
+    return 0;
+}
+
+// Émet une séquence: littéraux [lit, lit + lit_len) puis, si match_len, une copie
+static uint8_t *lz_emit(uint8_t *op, const uint8_t *oend, const uint8_t *lit, size_t lit_len,
+                        size_t offset, size_t match_len) {
+    if (op >= oend) return NULL;
+
+    uint8_t *token = op++;
+    *token = (uint8_t)((lit_len < LZ_RUN_MASK ? lit_len : LZ_RUN_MASK) << 4);
+    if (lit_len >= LZ_RUN_MASK && (op = lz_put_len(op, oend, lit_len - LZ_RUN_MASK)) == NULL) return NULL;
+
+    if (lit_len > (size_t)(oend - op)) return NULL;
+    memcpy(op, lit, lit_len);
+    op += lit_len;
+
+    if (match_len == 0) return op;
+
+    if (oend - op < 2) return NULL;
+    *op++ = (uint8_t)offset;
+    *op++ = (uint8_t)(offset >> 8);
+
+    size_t extra = match_len - LZ_MIN_MATCH;
+    *token |= (uint8_t)(extra < LZ_RUN_MASK ? extra : LZ_RUN_MASK);
+    if (extra >= LZ_RUN_MASK && (op = lz_put_len(op, oend, extra - LZ_RUN_MASK)) == NULL) return NULL;
+    return op;
+}
+
+/**
+ * Compresse src[0..len) dans dst (au plus cap octets).
+ * Retour: taille compressée, ou 0 si elle dépasserait cap.
+ */
+size_t lz_compress(const uint8_t *src, size_t len, uint8_t *dst, size_t cap) {
+    uint32_t table[1 << LZ_HASH_BITS];   // position + 1, 0 = case vide
+    const uint8_t *ip = src;
+    const uint8_t *anchor = src;
+    const uint8_t *end = src + len;
+    uint8_t *op = dst;
+    const uint8_t *oend = dst + cap;
+
+    memset(table, 0, sizeof(table));
+
+    while (end - ip >= LZ_MIN_MATCH) {
+        uint32_t h = lz_hash(ip);
+        const uint8_t *ref = table[h] ? src + table[h] - 1 : NULL;
+        table[h] = (uint32_t)(ip - src) + 1;
+
+        if (ref == NULL || ip - ref > LZ_MAX_OFFSET || memcmp(ref, ip, LZ_MIN_MATCH) != 0) {
+            ip++;
+            continue;
+        }
+
+        size_t match = LZ_MIN_MATCH;
+        while (ip + match < end && ref[match] == ip[match]) match++;
+
+        op = lz_emit(op, oend, anchor, (size_t)(ip - anchor), (size_t)(ip - ref), match);
+        if (op == NULL) return 0;
+        ip += match;
+        anchor = ip;
+    }
+
+    op = lz_emit(op, oend, anchor, (size_t)(end - anchor), 0, 0);
+    return op ? (size_t)(op - dst) : 0;
+}
+
+/**
+ * Décompresse src[0..len), qui doit produire exactement out_len octets.
+ * Chaque longueur et chaque distance est vérifiée: une entrée corrompue
+ * ne peut ni lire ni écrire hors des tampons.
+ * Retour: 0, ou -1 si l'entrée est invalide.
+ */
+int lz_decompress(const uint8_t *src, size_t len, uint8_t *dst, size_t out_len) {
+    const uint8_t *ip = src;
+    const uint8_t *iend = src + len;
+    uint8_t *op = dst;
+    uint8_t *oend = dst + out_len;
+
+    for (;;) {
+        if (ip >= iend) return -1;
+        uint8_t token = *ip++;
+
+        size_t lit_len = token >> 4;
+        if (lit_len == LZ_RUN_MASK && lz_get_len(&ip, iend, &lit_len) != 0) return -1;
+        if (lit_len > (size_t)(iend - ip) || lit_len > (size_t)(oend - op)) return -1;
+        memcpy(op, ip, lit_len);
+        ip += lit_len;
+        op += lit_len;
+
+        if (ip == iend) return (op == oend) ? 0 : -1;
+
+        if (iend - ip < 2) return -1;
+        size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+        ip += 2;
+
+        size_t match = token & LZ_RUN_MASK;
+        if (match == LZ_RUN_MASK && lz_get_len(&ip, iend, &match) != 0) return -1;
+        match += LZ_MIN_MATCH;
+        if (offset == 0 || offset > (size_t)(op - dst) || match > (size_t)(oend - op)) return -1;
+
+        // Copie octet par octet: la source peut chevaucher la destination
+        const uint8_t *ref = op - offset;
+        while (match--) *op++ = *ref++;
+    }
+}
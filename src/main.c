@@ -2,14 +2,118 @@
 
 static void print_usage() {
     puts("Usage:\n");
-    puts("  ./pwman init <db_file>           # Initialize a new vault\n");
+    puts("  ./pwman init <db_file> [<memory_kib> <passes>] # Initialize a new vault\n");
     puts("  ./pwman list <db_file>           # List all entries\n");
     puts("  ./pwman get <db_file>            # Retrieve a password\n");
     puts("  ./pwman add <db_file>            # Add a new entry\n");
+    puts("  ./pwman search <db_file> <query> # Find entries by substring or approximate match\n");
+    puts("  ./pwman compact <db_file> [<memory_kib> <passes>] # Fold the journal into the vault\n");
+    puts("  ./pwman import <db_file> <file>  # Import name,platform,user,password lines (CSV or TSV)\n");
+    puts("  ./pwman export <db_file> [tsv|json] # Write all entries to stdout\n");
+    puts("  ./pwman agent <db_file> [idle_s] # Keep the vault unlocked for get/list/add (default 900 s)\n");
+    puts("  ./pwman lock <db_file>           # Forget the cached key and stop the agent\n");
+    puts("  ./pwman bench-kdf [target_ms]    # Suggest KDF costs for this machine (default 250 ms)\n");
 }
 
+// Entier décimal non signé; retourne -1 si la chaîne n'en est pas un
+static int parse_uint(const char *s, uint32_t *out) {
+    uint64_t value = 0;
 
-int handle_init(const char *db_file) {
+    if (*s == '\0') return -1;
+    for (; *s; s++) {
+        if (*s < '0' || *s > '9') return -1;
+        value = value * 10 + (uint64_t)(*s - '0');
+        if (value > 0xffffffffULL) return -1;
+    }
+    *out = (uint32_t)value;
+    return 0;
+}
+
+// Coûts de KDF optionnels "<memory_kib> <passes>" en argv[first], argv[first + 1]
+static int parse_kdf_args(int argc, char **argv, int first, KdfParams *params) {
+    params->m_cost = KDF_DEFAULT_M_COST;
+    params->t_cost = KDF_DEFAULT_T_COST;
+    if (argc == first) return 0;
+    if (argc != first + 2
+        || parse_uint(argv[first], &params->m_cost) != 0 || parse_uint(argv[first + 1], &params->t_cost) != 0) {
+        return -1;
+    }
+    if (params->m_cost < KDF_MIN_M_COST || params->m_cost > KDF_MAX_M_COST
+        || params->t_cost < 1 || params->t_cost > KDF_MAX_T_COST) {
+        printf("Error: KDF memory must be %d..%d KiB and passes 1..%d.\n", KDF_MIN_M_COST, KDF_MAX_M_COST, KDF_MAX_T_COST);
+        return -1;
+    }
+    return 0;
+}
+
+#define IMPORT_LINE_MAX 1024
+#define IMPORT_FIELDS 4
+
+// Séquence d'échappement TSV (\t, \n, \r, \\) en src: caractère représenté, 0 sinon
+static char tsv_unescape(const char *src) {
+    if (src[0] != '\\') return 0;
+    if (src[1] == 't') return '\t';
+    if (src[1] == 'n') return '\n';
+    if (src[1] == 'r') return '\r';
+    if (src[1] == '\\') return '\\';
+    return 0;
+}
+
+/**
+ * Découpe une ligne d'import en place. Avec une tabulation dans la ligne, le
+ * format est TSV (pas de guillemets, \t \n \r \\ échappés comme à l'export);
+ * sinon CSV, où un champ peut être entre guillemets avec "" pour un guillemet
+ * littéral.
+ * Retourne le nombre de champs trouvés, ou -1 si un guillemet n'est pas fermé.
+ */
+static int split_import_line(char *line, char *fields[IMPORT_FIELDS]) {
+    char sep = ',';
+    for (char *c = line; *c; c++) {
+        if (*c == '\t') { sep = '\t'; break; }
+    }
+
+    int n = 0;
+    char *src = line;
+    while (n < IMPORT_FIELDS) {
+        char *dst = src;
+        fields[n++] = dst;
+
+        if (sep == ',' && *src == '"') {
+            src++;
+            while (1) {
+                if (*src == '\0') return -1;
+                if (*src == '"') {
+                    if (src[1] != '"') { src++; break; }
+                    src++;
+                }
+                *dst++ = *src++;
+            }
+        }
+        while (*src && *src != sep) {
+            char unescaped = (sep == '\t') ? tsv_unescape(src) : 0;
+            if (unescaped) {
+                *dst++ = unescaped;
+                src += 2;
+            } else {
+                *dst++ = *src++;
+            }
+        }
+
+        if (*src == '\0') { *dst = '\0'; break; }
+        src++;
+        *dst = '\0';
+    }
+    return (*src == '\0') ? n : n + 1;
+}
+
+static void strip_newline(char *line, ssize_t len) {
+    while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) {
+        line[--len] = '\0';
+    }
+}
+
+
+int handle_init(const char *db_file, const KdfParams *params) {
     char pass1[MAX_PASSWORD_LEN], pass2[MAX_PASSWORD_LEN];
 
     printf("Creating vault '%s'\n", db_file);
@@ -25,9 +129,16 @@ int handle_init(const char *db_file) {
     }
 
     Vault vault;
-    vault.count = 0;
+    vault_init(&vault);
     
-    if (save_vault(db_file, &vault, pass1) != 0) {
+    int ret = vault_set_password(&vault, pass1, params);
+    memset(pass1, 0, sizeof(pass1));
+    memset(pass2, 0, sizeof(pass2));
+    if (ret == 0) {
+        ret = save_vault(db_file, &vault);
+    }
+    vault_free(&vault);
+    if (ret != 0) {
         puts("Error creating vault.\n");
         return 1;
     }
@@ -44,11 +155,13 @@ int handle_list(const char *db_file, const char* master_pass) {
     }
 
     // Additional safety check (defense in depth)
-    if (vault.count < 0 || vault.count > MAX_ENTRIES) {
+    if (vault.count < 0 || vault.count > vault.capacity) {
         puts("Error: Corrupted vault data detected.\n");
+        vault_free(&vault);
         return 1;
     }
     
+    STATS_BEGIN(t_output);
     if (vault.count == 0) {
         puts("Vault is empty.\n");
     } else {
@@ -57,34 +170,90 @@ int handle_list(const char *db_file, const char* master_pass) {
             printf("- %s [%s] (%s)\n", vault.entries[i].name, vault.entries[i].platform, vault.entries[i].user);
         }
     }
+    STATS_END(t_output, "output");
+    vault_free(&vault);
     return 0;
 }
 
-int handle_get(const char *db_file, const char* master_pass) {
+/**
+ * Affiche les meilleures correspondances de `query` dans name, platform et user.
+ * L'index de trigrammes est construit dans une arène, effacée à la fin.
+ */
+static int print_search(const PwEntry *entries, int count, const char *query) {
+    SearchHit hits[SEARCH_MAX_RESULTS];
+    TrigramIndex index;
+    int total = -1;
+
+    arena_t *arena = arena_create(0);
+    STATS_BEGIN(t_index);
+    if (arena != NULL && trigram_index_build(&index, entries, count, arena) == 0) {
+        STATS_END(t_index, "search_index");
+        STATS_BEGIN(t_query);
+        total = trigram_search(&index, query, hits, SEARCH_MAX_RESULTS, arena);
+        STATS_END(t_query, "search_query");
+    }
+    arena_destroy(arena);
+
+    if (total < 0) {
+        puts("Error: Not enough memory for the search index.\n");
+        return 1;
+    }
+    if (total == 0) {
+        printf("No entries match '%s'.\n", query);
+        return 1;
+    }
+
+    int shown = (total < SEARCH_MAX_RESULTS) ? total : SEARCH_MAX_RESULTS;
+    printf("Matches for '%s' (%d):\n", query, total);
+    for (int i = 0; i < shown; i++) {
+        const PwEntry *e = &entries[hits[i].record];
+        printf("- %s [%s] (%s)\n", e->name, e->platform, e->user);
+    }
+    if (shown < total) {
+        printf("(best %d shown)\n", shown);
+    }
+    return 0;
+}
+
+int handle_search(const char *db_file, const char *query, const char* master_pass) {
     Vault vault;
     if (load_vault(db_file, &vault, master_pass) != 0) {
         puts("Incorrect password or corrupted file.\n");
         return 1;
     }
 
-    // Additional safety check (defense in depth)
-    if (vault.count < 0 || vault.count > MAX_ENTRIES) {
-        puts("Error: Corrupted vault data detected.\n");
+    int ret = print_search(vault.entries, vault.count, query);
+    vault_free(&vault);
+    return ret;
+}
+
+int handle_get(const char *db_file, const char* master_pass) {
+    VaultHandle handle;
+    if (vault_open(db_file, &handle, master_pass) != 0) {
+        puts("Incorrect password or corrupted file.\n");
         return 1;
     }
 
     char entry_name[MAX_NAME_LEN];
     printf("Entry name to retrieve: ");
-    if (readline(entry_name, MAX_NAME_LEN) < 0) return 1;
+    if (readline(entry_name, MAX_NAME_LEN) < 0) {
+        vault_close(&handle);
+        return 1;
+    }
 
-    for (int i = 0; i < vault.count; i++) {
-        if (strcmp(vault.entries[i].name, entry_name) == 0) {
-            printf("Entry: %s\n", vault.entries[i].name);
-            printf("Platform: %s\n", vault.entries[i].platform);
-            printf("Username: %s\n", vault.entries[i].user);
-            printf("Password: %s\n", vault.entries[i].password);
-            return 0;
-        }
+    PwEntry entry;
+    STATS_BEGIN(t_lookup);
+    int index = vault_find_entry(&handle, entry_name, &entry);
+    STATS_END(t_lookup, "lookup");
+    vault_close(&handle);
+
+    if (index >= 0) {
+        printf("Entry: %s\n", entry.name);
+        printf("Platform: %s\n", entry.platform);
+        printf("Username: %s\n", entry.user);
+        printf("Password: %s\n", entry.password);
+        memset(&entry, 0, sizeof(entry));
+        return 0;
     }
 
     printf("Error: No entry found for '%s'.\n", entry_name);
@@ -92,17 +261,156 @@ int handle_get(const char *db_file, const char* master_pass) {
 }
 
 int handle_add(const char *db_file, const char* master_pass) {
-    Vault vault;
-    if (load_vault(db_file, &vault, master_pass) != 0) {
+    VaultHandle handle;
+    if (vault_open(db_file, &handle, master_pass) != 0) {
         puts("Incorrect password or corrupted file.\n");
         return 1;
     }
 
-    if (vault.count >= MAX_ENTRIES) {
-        puts("Error: Vault is full.\n");
+    PwEntry entry;
+    char entry_name[MAX_NAME_LEN];
+    char platform[MAX_PLATFORM_LEN];
+    char user[MAX_USER_LEN];
+    char pass1[MAX_PASSWORD_LEN], pass2[MAX_PASSWORD_LEN];
+
+    printf("Entry name: ");
+    if (readline(entry_name, MAX_NAME_LEN) < 0) { vault_close(&handle); return 1; }
+
+    STATS_BEGIN(t_lookup);
+    int existing = vault_find_entry(&handle, entry_name, &entry);
+    STATS_END(t_lookup, "lookup");
+    if (existing >= 0) {
+        printf("Error: An entry named '%s' already exists.\n", entry_name);
+        memset(&entry, 0, sizeof(entry));
+        vault_close(&handle);
         return 1;
     }
 
+    printf("Platform: ");
+    if (readline(platform, MAX_PLATFORM_LEN) < 0) { vault_close(&handle); return 1; }
+
+    printf("Username: ");
+    if (readline(user, MAX_USER_LEN) < 0) { vault_close(&handle); return 1; }
+
+    printf("Password: ");
+    if (readline(pass1, MAX_PASSWORD_LEN) < 0) { vault_close(&handle); return 1; }
+    printf("Confirm password: ");
+    if (readline(pass2, MAX_PASSWORD_LEN) < 0) { vault_close(&handle); return 1; }
+
+    if (strcmp(pass1, pass2) != 0) {
+        puts("Passwords do not match.\n");
+        vault_close(&handle);
+        return 1;
+    }
+
+    memset(&entry, 0, sizeof(entry));
+    memcpy(entry.name, entry_name, strlen(entry_name) + 1);
+    memcpy(entry.platform, platform, strlen(platform) + 1);
+    memcpy(entry.user, user, strlen(user) + 1);
+    memcpy(entry.password, pass1, strlen(pass1) + 1);
+
+    // Ajout en fin de journal: le reste du coffre n'est ni relu ni réécrit
+    STATS_BEGIN(t_append);
+    int ret = vault_journal_append(db_file, &handle, &entry);
+    STATS_END(t_append, "journal_append");
+    memset(&entry, 0, sizeof(entry));
+    vault_close(&handle);
+    if (ret != 0) {
+        puts("Error saving vault.\n");
+        return 1;
+    }
+
+    printf("Entry '%s' added successfully.\n", entry_name);
+    printf("Platform: %s\n", platform);
+    printf("Username: %s\n", user);
+    return 0;
+}
+
+// --- Commandes servies par un agent (voir agent.c): pas de mot de passe ni de KDF ---
+
+static int agent_get_entry(int agent_fd, const char *name, PwEntry *out, AgentReply *reply) {
+    PwEntry request, *entries;
+
+    memset(&request, 0, sizeof(request));
+    memcpy(request.name, name, strlen(name) + 1);
+    if (agent_call(agent_fd, AGENT_OP_GET, &request, reply, &entries) != 0) return -1;
+
+    if (entries != NULL) {
+        memcpy(out, entries, sizeof(PwEntry));
+        memset(entries, 0, (size_t)reply->count * sizeof(PwEntry));
+        free(entries);
+    }
+    return 0;
+}
+
+int handle_agent_list(int agent_fd) {
+    AgentReply reply;
+    PwEntry *entries;
+
+    if (agent_call(agent_fd, AGENT_OP_LIST, NULL, &reply, &entries) != 0 || reply.status != AGENT_OK) {
+        puts("Error: The agent did not answer.\n");
+        return 1;
+    }
+
+    if (reply.count == 0) {
+        puts("Vault is empty.\n");
+    } else {
+        printf("Entries in vault (%d):\n", (int)reply.count);
+        for (uint32_t i = 0; i < reply.count; i++) {
+            printf("- %s [%s] (%s)\n", entries[i].name, entries[i].platform, entries[i].user);
+        }
+        memset(entries, 0, (size_t)reply.count * sizeof(PwEntry));
+        free(entries);
+    }
+    return 0;
+}
+
+// La liste de l'agent (sans mots de passe) suffit pour indexer localement
+int handle_agent_search(int agent_fd, const char *query) {
+    AgentReply reply;
+    PwEntry *entries;
+
+    if (agent_call(agent_fd, AGENT_OP_LIST, NULL, &reply, &entries) != 0 || reply.status != AGENT_OK) {
+        puts("Error: The agent did not answer.\n");
+        return 1;
+    }
+
+    int ret = print_search(entries, (int)reply.count, query);
+    if (entries != NULL) {
+        memset(entries, 0, (size_t)reply.count * sizeof(PwEntry));
+        free(entries);
+    }
+    return ret;
+}
+
+int handle_agent_get(int agent_fd) {
+    char entry_name[MAX_NAME_LEN];
+    printf("Entry name to retrieve: ");
+    if (readline(entry_name, MAX_NAME_LEN) < 0) return 1;
+
+    PwEntry entry;
+    AgentReply reply;
+    if (agent_get_entry(agent_fd, entry_name, &entry, &reply) != 0) {
+        puts("Error: The agent did not answer.\n");
+        return 1;
+    }
+
+    if (reply.status == AGENT_OK && reply.count == 1) {
+        printf("Entry: %s\n", entry.name);
+        printf("Platform: %s\n", entry.platform);
+        printf("Username: %s\n", entry.user);
+        printf("Password: %s\n", entry.password);
+        memset(&entry, 0, sizeof(entry));
+        return 0;
+    }
+
+    printf("Error: No entry found for '%s'.\n", entry_name);
+    return 1;
+}
+
+int handle_agent_add(int agent_fd) {
+    PwEntry entry;
+    AgentReply reply;
     char entry_name[MAX_NAME_LEN];
     char platform[MAX_PLATFORM_LEN];
     char user[MAX_USER_LEN];
@@ -111,11 +419,14 @@ int handle_add(const char *db_file, const char* master_pass) {
     printf("Entry name: ");
     if (readline(entry_name, MAX_NAME_LEN) < 0) return 1;
 
-    for (int i = 0; i < vault.count; i++) {
-        if (strcmp(vault.entries[i].name, entry_name) == 0) {
-            printf("Error: An entry named '%s' already exists.\n", entry_name);
-            return 1;
-        }
+    if (agent_get_entry(agent_fd, entry_name, &entry, &reply) != 0) {
+        puts("Error: The agent did not answer.\n");
+        return 1;
+    }
+    memset(&entry, 0, sizeof(entry));
+    if (reply.status == AGENT_OK) {
+        printf("Error: An entry named '%s' already exists.\n", entry_name);
+        return 1;
     }
 
     printf("Platform: ");
@@ -134,16 +445,24 @@ int handle_add(const char *db_file, const char* master_pass) {
         return 1;
     }
 
-    memcpy(vault.entries[vault.count].name, entry_name, strlen(entry_name) + 1);
-    memcpy(vault.entries[vault.count].platform, platform, strlen(platform) + 1);
-    memcpy(vault.entries[vault.count].user, user, strlen(user) + 1);
-    memcpy(vault.entries[vault.count].password, pass1, strlen(pass1) + 1);
-    vault.count++;
-    
-    if (save_vault(db_file, &vault, master_pass) != 0) {
+    memcpy(entry.name, entry_name, strlen(entry_name) + 1);
+    memcpy(entry.platform, platform, strlen(platform) + 1);
+    memcpy(entry.user, user, strlen(user) + 1);
+    memcpy(entry.password, pass1, strlen(pass1) + 1);
+
+    PwEntry *unused;
+    int ret = agent_call(agent_fd, AGENT_OP_ADD, &entry, &reply, &unused);
+    memset(&entry, 0, sizeof(entry));
+    memset(pass1, 0, sizeof(pass1));
+    memset(pass2, 0, sizeof(pass2));
+    if (ret != 0 || reply.status == AGENT_FAILED) {
         puts("Error saving vault.\n");
         return 1;
     }
+    if (reply.status == AGENT_EXISTS) {
+        printf("Error: An entry named '%s' already exists.\n", entry_name);
+        return 1;
+    }
 
     printf("Entry '%s' added successfully.\n", entry_name);
     printf("Platform: %s\n", platform);
@@ -151,7 +470,365 @@ int handle_add(const char *db_file, const char* master_pass) {
     return 0;
 }
 
-int main(int argc, char **argv) {
+int handle_lock(const char *db_file) {
+    int forgotten = (vault_forget_key(db_file) == 0);
+
+    int agent_fd = agent_connect(db_file);
+    if (agent_fd < 0) {
+        puts(forgotten ? "Cached key removed, vault locked.\n" : "Vault is not unlocked.\n");
+        return forgotten ? 0 : 1;
+    }
+
+    AgentReply reply;
+    PwEntry *unused;
+    int ret = agent_call(agent_fd, AGENT_OP_LOCK, NULL, &reply, &unused);
+    close(agent_fd);
+    if (ret != 0) {
+        puts("Error: The agent did not answer.\n");
+        return 1;
+    }
+    puts("Agent stopped, vault locked.\n");
+    return 0;
+}
+
+/**
+ * Réécrit le snapshot avec le journal rejoué. Avec de nouveaux coûts de KDF,
+ * la clé est redérivée (nouveau sel) et tout le coffre est rechiffré;
+ * la clé en cache dans le trousseau est remplacée par la nouvelle.
+ */
+int handle_compact(const char *db_file, const char* master_pass, const KdfParams *params) {
+    Vault vault;
+    if (load_vault(db_file, &vault, master_pass) != 0) {
+        puts("Incorrect password or corrupted file.\n");
+        return 1;
+    }
+
+    int ret = 0;
+    if (params != NULL) {
+        keycache_forget(vault.salt);
+        ret = vault_set_password(&vault, master_pass, params);
+    }
+    // Le snapshot réécrit contient déjà les entrées du journal rejoué
+    if (ret == 0) {
+        ret = save_vault(db_file, &vault);
+    }
+    if (ret == 0 && params != NULL) {
+        keycache_store(vault.salt, vault.key);
+    }
+    int count = vault.count;
+    vault_free(&vault);
+    if (ret != 0) {
+        puts("Error saving vault.\n");
+        return 1;
+    }
+
+    printf("Vault compacted (%d entries).\n", count);
+    return 0;
+}
+
+/**
+ * Import en masse: le coffre est chargé une fois, toutes les lignes sont
+ * ajoutées en mémoire (doublons détectés par l'index), puis un seul
+ * chiffrement et une seule écriture ont lieu à la fin.
+ */
+int handle_import(const char *db_file, const char *import_file, const char* master_pass) {
+    int fd = open(import_file, O_RDONLY, 0);
+    if (fd < 0) {
+        printf("Error: Cannot open '%s'.\n", import_file);
+        return 1;
+    }
+
+    Vault vault;
+    if (load_vault(db_file, &vault, master_pass) != 0) {
+        puts("Incorrect password or corrupted file.\n");
+        close(fd);
+        return 1;
+    }
+
+    size_t line_size = IMPORT_LINE_MAX;
+    char *line = malloc(line_size);
+    if (line == NULL) {
+        vault_free(&vault);
+        close(fd);
+        return 1;
+    }
+
+    int line_no = 0, imported = 0, skipped = 0;
+    ssize_t len;
+    char *fields[IMPORT_FIELDS];
+
+    STATS_BEGIN(t_parse);
+    while ((len = getline(&line, &line_size, fd)) >= 0) {
+        line_no++;
+        strip_newline(line, len);
+        if (line[0] == '\0') continue;
+
+        int n = split_import_line(line, fields);
+        if (n != IMPORT_FIELDS) {
+            printf("Line %d: expected name, platform, user, password.\n", line_no);
+            skipped++;
+            continue;
+        }
+        if (line_no == 1 && strcmp(fields[0], "name") == 0) continue;
+
+        if (fields[0][0] == '\0' || strlen(fields[0]) >= MAX_NAME_LEN || strlen(fields[1]) >= MAX_PLATFORM_LEN
+            || strlen(fields[2]) >= MAX_USER_LEN || strlen(fields[3]) >= MAX_PASSWORD_LEN) {
+            printf("Line %d: empty name or field too long.\n", line_no);
+            skipped++;
+            continue;
+        }
+        if (vault_lookup(&vault, fields[0]) >= 0) {
+            printf("Line %d: an entry named '%s' already exists.\n", line_no, fields[0]);
+            skipped++;
+            continue;
+        }
+
+        PwEntry *entry = vault_append(&vault, fields[0]);
+        if (entry == NULL) {
+            puts("Error: Vault is full.\n");
+            break;
+        }
+        memcpy(entry->platform, fields[1], strlen(fields[1]) + 1);
+        memcpy(entry->user, fields[2], strlen(fields[2]) + 1);
+        memcpy(entry->password, fields[3], strlen(fields[3]) + 1);
+        imported++;
+    }
+    STATS_END(t_parse, "parse");
+
+    memset(line, 0, line_size);
+    free(line);
+    close(fd);
+
+    int ret = 0;
+    if (imported > 0) {
+        ret = save_vault(db_file, &vault);
+    }
+    vault_free(&vault);
+    if (ret != 0) {
+        puts("Error saving vault.\n");
+        return 1;
+    }
+
+    printf("Imported %d entries (%d skipped).\n", imported, skipped);
+    return 0;
+}
+
+#define EXPORT_CHUNK 64
+// L'export écrit via le tampon de stdout de la libc (un write() par 64 Kio)
+static int export_error = 0;
+
+static void export_write(const char *s, size_t n) {
+    if (stdout_write(s, n) < 0) export_error = 1;
+}
+
+static void export_str(const char *s) {
+    export_write(s, strlen(s));
+}
+
+// Chaîne JSON: guillemets, antislash et caractères de contrôle échappés
+static void export_json_str(const char *s) {
+    static const char hex[] = "0123456789abcdef";
+    const char *run = s;
+
+    export_write("\"", 1);
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+        export_write(run, s - run);
+        run = s + 1;
+        if (c == '"') export_write("\\\"", 2);
+        else if (c == '\\') export_write("\\\\", 2);
+        else {
+            char esc[6] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 15] };
+            export_write(esc, 6);
+        }
+    }
+    export_write(run, s - run);
+    export_write("\"", 1);
+}
+
+// Champ TSV: tabulation, fin de ligne et antislash échappés (relus par import)
+static void export_tsv_str(const char *s) {
+    const char *run = s;
+
+    for (; *s; s++) {
+        const char *esc = (*s == '\t') ? "\\t" : (*s == '\n') ? "\\n"
+                        : (*s == '\r') ? "\\r" : (*s == '\\') ? "\\\\" : NULL;
+        if (esc == NULL) continue;
+
+        export_write(run, s - run);
+        export_write(esc, 2);
+        run = s + 1;
+    }
+    export_write(run, s - run);
+}
+
+static void export_entry(const PwEntry *entry, int json, int first) {
+    if (json) {
+        export_str(first ? "\n  {\"name\": " : ",\n  {\"name\": ");
+        export_json_str(entry->name);
+        export_str(", \"platform\": ");
+        export_json_str(entry->platform);
+        export_str(", \"user\": ");
+        export_json_str(entry->user);
+        export_str(", \"password\": ");
+        export_json_str(entry->password);
+        export_str("}");
+    } else {
+        export_tsv_str(entry->name);
+        export_write("\t", 1);
+        export_tsv_str(entry->platform);
+        export_write("\t", 1);
+        export_tsv_str(entry->user);
+        export_write("\t", 1);
+        export_tsv_str(entry->password);
+        export_write("\n", 1);
+    }
+}
+
+/**
+ * Export en flux: le snapshot puis le journal sont déchiffrés par paquets de
+ * EXPORT_CHUNK entrées et écrits via le tampon de stdout, la mémoire reste
+ * constante quelle que soit la taille du coffre. Le TSV produit (avec sa
+ * ligne d'en-tête, champs échappés) est relisible par import.
+ */
+int handle_export(const char *db_file, const char *format, const char* master_pass) {
+    int json;
+    if (strcmp(format, "tsv") == 0) json = 0;
+    else if (strcmp(format, "json") == 0) json = 1;
+    else { print_usage(); return 1; }
+
+    VaultHandle handle;
+    if (vault_open(db_file, &handle, master_pass) != 0) {
+        puts("Incorrect password or corrupted file.\n");
+        return 1;
+    }
+
+    // Le paquet déchiffré vit dans une arène, effacée par arena_destroy()
+    arena_t *arena = arena_create(0);
+    PwEntry *chunk = arena ? arena_alloc(arena, EXPORT_CHUNK * sizeof(PwEntry)) : NULL;
+    if (chunk == NULL) {
+        arena_destroy(arena);
+        vault_close(&handle);
+        puts("Error: Out of memory.\n");
+        return 1;
+    }
+    int ret = 0, written = 0;
+
+    export_str(json ? "[" : "name\tplatform\tuser\tpassword\n");
+
+    int total = handle.count + handle.journal_count;
+    for (int first = 0; first < total && ret == 0 && !export_error; first += EXPORT_CHUNK) {
+        int n = total - first;
+        if (n > EXPORT_CHUNK) n = EXPORT_CHUNK;
+
+        // Un paquet peut chevaucher la fin du snapshot et le début du journal
+        int from_snapshot = (first < handle.count) ? handle.count - first : 0;
+        if (from_snapshot > n) from_snapshot = n;
+        STATS_BEGIN(t_decrypt);
+        if (from_snapshot > 0) {
+            ret = vault_read_entries(&handle, first, from_snapshot, chunk);
+        }
+        if (ret == 0 && n > from_snapshot) {
+            ret = vault_read_journal(&handle, first + from_snapshot - handle.count, n - from_snapshot, chunk + from_snapshot);
+        }
+        STATS_END(t_decrypt, "decrypt_entries");
+
+        STATS_BEGIN(t_output);
+        for (int i = 0; i < n && ret == 0; i++) {
+            chunk[i].name[MAX_NAME_LEN - 1] = '\0';
+            chunk[i].platform[MAX_PLATFORM_LEN - 1] = '\0';
+            chunk[i].user[MAX_USER_LEN - 1] = '\0';
+            chunk[i].password[MAX_PASSWORD_LEN - 1] = '\0';
+            export_entry(&chunk[i], json, written++ == 0);
+        }
+        STATS_END(t_output, "output");
+    }
+
+    export_str(json ? (written ? "\n]\n" : "]\n") : "");
+    if (stdout_flush() < 0) export_error = 1;
+
+    arena_destroy(arena);
+    vault_close(&handle);
+
+    if (ret != 0 || export_error) {
+        puts("Error: Export failed.\n");
+        return 1;
+    }
+    return 0;
+}
+
+#define BENCH_KDF_MAX_M_COST (1024 * 1024) // 1 Gio
+#define BENCH_KDF_DEFAULT_MS 250
+
+// Durée d'une dérivation en millisecondes, -1 si la mémoire manque
+static long kdf_time_ms(const KdfParams *params) {
+    static const uint8_t salt[KDF_SALT_LEN];
+    uint8_t key[MASTER_KEY_LEN];
+    struct timespec start, end;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int ret = kdf_derive("bench-kdf", salt, params, key);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    memset(key, 0, sizeof(key));
+    if (ret != 0) return -1;
+
+    long ms = (end.tv_sec - start.tv_sec) * 1000 + (end.tv_nsec - start.tv_nsec) / 1000000;
+    return ms > 0 ? ms : 1;
+}
+
+/**
+ * Calibre la KDF pour un temps de déverrouillage cible: la mémoire est
+ * doublée jusqu'à la moitié de la cible puis ajustée linéairement (le coût
+ * est proportionnel à la mémoire); les passes ne servent qu'au-delà du
+ * plafond de BENCH_KDF_MAX_M_COST.
+ */
+int handle_bench_kdf(long target_ms) {
+    KdfParams params = { 1024, 1 };
+    long ms = kdf_time_ms(&params);
+
+    while (ms >= 0 && ms < target_ms / 2 && params.m_cost < BENCH_KDF_MAX_M_COST) {
+        params.m_cost *= 2;
+        ms = kdf_time_ms(&params);
+    }
+    if (ms < 0) {
+        puts("Error: Not enough memory to run the KDF.\n");
+        return 1;
+    }
+
+    // Coût ~ (1 + t_cost) * m_cost: remplissage puis t_cost passes
+    uint64_t m_cost = (uint64_t)params.m_cost * target_ms / ms;
+    if (m_cost > BENCH_KDF_MAX_M_COST) {
+        params.t_cost = (uint32_t)(2 * m_cost / BENCH_KDF_MAX_M_COST - 1);
+        m_cost = BENCH_KDF_MAX_M_COST;
+    }
+    if (params.t_cost > KDF_MAX_T_COST) params.t_cost = KDF_MAX_T_COST;
+    params.m_cost = (m_cost < KDF_MIN_M_COST) ? KDF_MIN_M_COST : (uint32_t)m_cost;
+
+    ms = kdf_time_ms(&params);
+    if (ms < 0) {
+        puts("Error: Not enough memory to run the KDF.\n");
+        return 1;
+    }
+
+    printf("Target unlock time: %d ms\n", (int)target_ms);
+    printf("Memory: %d KiB, passes: %d -> %d ms per unlock\n", (int)params.m_cost, (int)params.t_cost, (int)ms);
+    printf("New vault:      ./pwman init <db_file> %d %d\n", (int)params.m_cost, (int)params.t_cost);
+    printf("Existing vault: ./pwman compact <db_file> %d %d\n", (int)params.m_cost, (int)params.t_cost);
+    return 0;
+}
+
+static int run_command(int argc, char **argv) {
+    if (argc >= 2 && strcmp(argv[1], "bench-kdf") == 0) {
+        uint32_t target_ms = BENCH_KDF_DEFAULT_MS;
+        if (argc > 3 || (argc == 3 && (parse_uint(argv[2], &target_ms) != 0 || target_ms == 0))) {
+            print_usage();
+            return 1;
+        }
+        return handle_bench_kdf(target_ms);
+    }
+
     if (argc < 3) {
         print_usage();
         return 1;
@@ -159,17 +836,64 @@ int main(int argc, char **argv) {
 
     const char *command = argv[1];
     const char *db_file = argv[2];
+    KdfParams kdf_params;
 
     if (strcmp(command, "init") == 0) {
+        if (parse_kdf_args(argc, argv, 3, &kdf_params) != 0) { print_usage(); return 1; }
+        return handle_init(db_file, &kdf_params);
+    }
+    if (strcmp(command, "lock") == 0) {
         if (argc != 3) { print_usage(); return 1; }
-        return handle_init(db_file);
+        return handle_lock(db_file);
     }
 
-    char master_pass[MAX_PASSWORD_LEN];
-    printf("Please enter master password: ");
-    if (readline(master_pass, MAX_PASSWORD_LEN) < 0) {
+    if (strcmp(command, "search") == 0 && (argc != 4 || argv[3][0] == '\0' || strlen(argv[3]) >= MAX_NAME_LEN)) {
+        print_usage();
         return 1;
     }
+    if (strcmp(command, "search") == 0) {
+        int agent_fd = agent_connect(db_file);
+        if (agent_fd >= 0) {
+            int ret = handle_agent_search(agent_fd, argv[3]);
+            close(agent_fd);
+            return ret;
+        }
+    }
+
+    // Un agent déverrouillé répond à get/list/add sans mot de passe
+    if (argc == 3 && (strcmp(command, "list") == 0 || strcmp(command, "get") == 0 || strcmp(command, "add") == 0)) {
+        int agent_fd = agent_connect(db_file);
+        if (agent_fd >= 0) {
+            int ret = (command[0] == 'l') ? handle_agent_list(agent_fd)
+                    : (command[0] == 'g') ? handle_agent_get(agent_fd) : handle_agent_add(agent_fd);
+            close(agent_fd);
+            return ret;
+        }
+    }
+
+    // Clé encore dans le trousseau de session: pas de KDF. L'invite n'est sautée
+    // que sur un terminal: lue d'un pipe, la ligne du mot de passe est toujours
+    // consommée (puis ignorée), sinon la suite de stdin dépendrait du cache.
+    // compact avec de nouveaux coûts a besoin du mot de passe pour redériver.
+    char master_pass_buf[MAX_PASSWORD_LEN];
+    const char *master_pass = NULL;
+    int rekey = (strcmp(command, "compact") == 0 && argc == 5);
+    int cached = !rekey && vault_key_cached(db_file);
+    if (!cached || !isatty(0)) {
+        // L'invite va sur stderr pour ne pas polluer une sortie redirigée (export)
+        const char *prompt = "Please enter master password: ";
+        STATS_BEGIN(t_prompt);
+        write(2, prompt, strlen(prompt));
+        if (readline(master_pass_buf, MAX_PASSWORD_LEN) < 0) {
+            return 1;
+        }
+        STATS_END(t_prompt, "prompt");
+        if (cached) {
+            memset(master_pass_buf, 0, sizeof(master_pass_buf));
+        } else {
+            master_pass = master_pass_buf;
+        }
+    }
 
     if (strcmp(command, "list") == 0) {
         if (argc != 3) { print_usage(); return 1; }
@@ -183,6 +907,29 @@ int main(int argc, char **argv) {
         if (argc != 3) { print_usage(); return 1; }
         return handle_add(db_file, master_pass);
     }
+    else if (strcmp(command, "search") == 0) {
+        return handle_search(db_file, argv[3], master_pass);
+    }
+    else if (strcmp(command, "import") == 0) {
+        if (argc != 4) { print_usage(); return 1; }
+        return handle_import(db_file, argv[3], master_pass);
+    }
+    else if (strcmp(command, "export") == 0) {
+        if (argc != 3 && argc != 4) { print_usage(); return 1; }
+        return handle_export(db_file, (argc == 4) ? argv[3] : "tsv", master_pass);
+    }
+    else if (strcmp(command, "agent") == 0) {
+        uint32_t idle = AGENT_DEFAULT_IDLE;
+        if (argc > 4 || (argc == 4 && (parse_uint(argv[3], &idle) != 0 || idle == 0 || idle > AGENT_MAX_IDLE))) {
+            print_usage();
+            return 1;
+        }
+        return (agent_run(db_file, master_pass, (int)idle) == 0) ? 0 : 1;
+    }
+    else if (strcmp(command, "compact") == 0) {
+        if (parse_kdf_args(argc, argv, 3, &kdf_params) != 0) { print_usage(); return 1; }
+        return handle_compact(db_file, master_pass, (argc == 5) ? &kdf_params : NULL);
+    }
     else {
         puts("Unknown command.\n");
         print_usage();
@@ -190,4 +937,46 @@ int main(int argc, char **argv) {
     }
 
     return 0;
-}
\ No newline at end of file
+}
+
+// --stats avant la commande, ou PWMAN_STATS=1 dans l'environnement
+static int stats_requested(int *argc, char **argv, char **envp) {
+    int requested = 0;
+
+    if (*argc >= 2 && strcmp(argv[1], "--stats") == 0) {
+        for (int i = 1; i < *argc; i++) argv[i] = argv[i + 1];
+        (*argc)--;
+        requested = 1;
+    }
+    for (int i = 0; envp[i] != NULL; i++) {
+        if (strcmp(envp[i], "PWMAN_STATS=1") == 0) requested = 1;
+    }
+    return requested;
+}
+
+/**
+ * Avec les statistiques demandées, le rapport (stats.c) est écrit sur stderr
+ * après la commande et le vidage de stdout.
+ */
+int main(int argc, char **argv, char **envp) {
+    int stats = stats_requested(&argc, argv, envp);
+
+#ifdef PWMAN_STATS
+    if (stats) stats_enable();
+
+    STATS_BEGIN(t_total);
+    int ret = run_command(argc, argv);
+    STATS_BEGIN(t_flush);
+    stdout_flush();
+    STATS_END(t_flush, "flush_stdout");
+    STATS_END(t_total, "total");
+    stats_report();
+    return ret;
+#else
+    if (stats) {
+        const char *msg = "Warning: pwman was built without statistics (make re STATS=1).\n";
+        write(2, msg, strlen(msg));
+    }
+    return run_command(argc, argv);
+#endif
+}
@@ -0,0 +1,84 @@
+#include "pwman.h"
+
+/*
+ * Noyau Poly1305 AVX2: 4 blocs par itération.
+ *
+ * La voie j accumule les blocs j, j + 4, j + 8... et chaque voie est
+ * multipliée par r^4; au dernier groupe, la voie j est multipliée par
+ * r^(4 - j), si bien que la somme des voies vaut exactement le h du calcul
+ * séquentiel. Les limbs de 26 bits tiennent dans les 32 bits bas de chaque
+ * voie de 64 bits: vpmuludq fait les 4 produits 32x32 -> 64 d'un coup.
+ * Le code scalaire de crypto.c reste la référence.
+ */
+
+typedef uint64_t v4q __attribute__((vector_size(32)));
+typedef int v8i __attribute__((vector_size(32)));
+
+#define POLY1305_MASK 0x3ffffff
+
+#define MUL_V(a, b) ((v4q)__builtin_ia32_pmuludq256((v8i)(a), (v8i)(b)))
+
+// Lit 4 octets (little-endian)
+static uint32_t load32(const uint8_t *p) {
+    return ((uint32_t)p[0]) | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * Absorbe n_blocks (multiple de 4) blocs complets de 16 octets dans h,
+ * r_pow[i] valant r^(i + 1).
+ */
+__attribute__((target("avx2")))
+void poly1305_blocks_avx2(uint32_t h[5], const uint32_t r_pow[4][5], const uint8_t *m, size_t n_blocks) {
+    const v4q mask = { POLY1305_MASK, POLY1305_MASK, POLY1305_MASK, POLY1305_MASK };
+    v4q r4[5], s4[5], rl[5], sl[5], acc[5];
+
+    for (int k = 0; k < 5; k++) {
+        r4[k] = (v4q){ r_pow[3][k], r_pow[3][k], r_pow[3][k], r_pow[3][k] };
+        rl[k] = (v4q){ r_pow[3][k], r_pow[2][k], r_pow[1][k], r_pow[0][k] };
+        s4[k] = r4[k] * 5;
+        sl[k] = rl[k] * 5;
+        acc[k] = (v4q){ h[k], 0, 0, 0 };
+    }
+
+    for (; n_blocks >= 4; n_blocks -= 4, m += 64) {
+        for (int j = 0; j < 4; j++) {
+            const uint8_t *b = m + 16 * j;
+            acc[0][j] += load32(b + 0) & POLY1305_MASK;
+            acc[1][j] += (load32(b + 3) >> 2) & POLY1305_MASK;
+            acc[2][j] += (load32(b + 6) >> 4) & POLY1305_MASK;
+            acc[3][j] += (load32(b + 9) >> 6) & POLY1305_MASK;
+            acc[4][j] += (load32(b + 12) >> 8) | (1 << 24);
+        }
+
+        const v4q *r = (n_blocks == 4) ? rl : r4;
+        const v4q *s = (n_blocks == 4) ? sl : s4;
+
+        v4q d0 = MUL_V(acc[0], r[0]) + MUL_V(acc[1], s[4]) + MUL_V(acc[2], s[3]) + MUL_V(acc[3], s[2]) + MUL_V(acc[4], s[1]);
+        v4q d1 = MUL_V(acc[0], r[1]) + MUL_V(acc[1], r[0]) + MUL_V(acc[2], s[4]) + MUL_V(acc[3], s[3]) + MUL_V(acc[4], s[2]);
+        v4q d2 = MUL_V(acc[0], r[2]) + MUL_V(acc[1], r[1]) + MUL_V(acc[2], r[0]) + MUL_V(acc[3], s[4]) + MUL_V(acc[4], s[3]);
+        v4q d3 = MUL_V(acc[0], r[3]) + MUL_V(acc[1], r[2]) + MUL_V(acc[2], r[1]) + MUL_V(acc[3], r[0]) + MUL_V(acc[4], s[4]);
+        v4q d4 = MUL_V(acc[0], r[4]) + MUL_V(acc[1], r[3]) + MUL_V(acc[2], r[2]) + MUL_V(acc[3], r[1]) + MUL_V(acc[4], r[0]);
+
+        // Réduction partielle, voie par voie, comme poly1305_mul
+        d1 += d0 >> 26; acc[0] = d0 & mask;
+        d2 += d1 >> 26; acc[1] = d1 & mask;
+        d3 += d2 >> 26; acc[2] = d2 & mask;
+        d4 += d3 >> 26; acc[3] = d3 & mask;
+        v4q t = acc[0] + (d4 >> 26) * 5; acc[4] = d4 & mask;
+        acc[0] = t & mask;
+        acc[1] += t >> 26;
+    }
+
+    // Somme des voies puis réduction partielle (chaque somme < 2^29)
+    uint64_t sum[5];
+    for (int k = 0; k < 5; k++) sum[k] = acc[k][0] + acc[k][1] + acc[k][2] + acc[k][3];
+
+    sum[1] += sum[0] >> 26; sum[0] &= POLY1305_MASK;
+    sum[2] += sum[1] >> 26; sum[1] &= POLY1305_MASK;
+    sum[3] += sum[2] >> 26; sum[2] &= POLY1305_MASK;
+    sum[4] += sum[3] >> 26; sum[3] &= POLY1305_MASK;
+    sum[0] += (sum[4] >> 26) * 5; sum[4] &= POLY1305_MASK;
+    sum[1] += sum[0] >> 26; sum[0] &= POLY1305_MASK;
+
+    for (int k = 0; k < 5; k++) h[k] = (uint32_t)sum[k];
+}
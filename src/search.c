@@ -0,0 +1,272 @@
+#include "pwman.h"
+
+/*
+ * Recherche par sous-chaîne et approchée (commande search).
+ *
+ * Les candidats sont les entrées dont un champ partage assez de trigrammes
+ * avec la requête: une faute de frappe en détruit au plus
+ * SEARCH_TYPO_TRIGRAMS, un candidat doit donc en retrouver au moins
+ * (trigrammes de la requête - 3) dans un même champ, et pour une requête
+ * courte tous sauf un, 3 au plus (voir trigram_search). Chaque candidat est
+ * ensuite vérifié sur son texte: s'il existe des sous-chaînes exactes
+ * (memmem), seules elles sont retenues; sinon les correspondances
+ * approchées sont classées par proportion de trigrammes retrouvés.
+ * Toute la mémoire vient de l'arène de l'appelant (effacée à sa destruction).
+ */
+
+#define SEARCH_TYPO_TRIGRAMS 3
+#define SCORE_EXACT   1000   // sous-chaîne exacte (approchée: 0..100)
+#define SCORE_IN_NAME 200    // trouvée dans le nom
+#define SCORE_PREFIX  100    // au début d'un champ
+#define SCORE_WHOLE   100    // le champ entier
+
+#define RECORD_TEXT_MAX (MAX_NAME_LEN + MAX_PLATFORM_LEN + MAX_USER_LEN)
+
+static char to_lower(char c) {
+    return (c >= 'A' && c <= 'Z') ? (char)(c + ('a' - 'A')) : c;
+}
+
+static uint32_t trigram_bucket(const char *p) {
+    uint32_t key = ((uint32_t)(uint8_t)p[0] << 16) | ((uint32_t)(uint8_t)p[1] << 8) | (uint8_t)p[2];
+    return (key * 2654435761u) >> (32 - TRIGRAM_BITS);
+}
+
+// Copie un champ en minuscules suivi de '\n'; retourne la longueur écrite
+static size_t append_field(char *out, const char *field, size_t max) {
+    size_t n = 0;
+    while (n < max && field[n] != '\0') {
+        out[n] = to_lower(field[n]);
+        n++;
+    }
+    out[n] = '\n';
+    return n + 1;
+}
+
+// Cases des trigrammes de `text` (aucun ne chevauche deux champs), et si
+// `fields` n'est pas NULL le numéro du champ de chacun
+static int text_trigrams(const char *text, size_t len, uint32_t *buckets, uint32_t *fields) {
+    int n = 0;
+    uint32_t field = 0;
+    for (size_t i = 0; i + 3 <= len; i++) {
+        if (text[i] == '\n') field++;
+        if (text[i] != '\n' && text[i + 1] != '\n' && text[i + 2] != '\n') {
+            if (fields != NULL) fields[n] = field;
+            buckets[n++] = trigram_bucket(text + i);
+        }
+    }
+    return n;
+}
+
+/**
+ * Construit l'index des `count` entrées (deux passes: comptage des listes,
+ * puis remplissage). Un trigramme répété dans un champ n'y est listé qu'une fois.
+ */
+int trigram_index_build(TrigramIndex *index, const PwEntry *entries, int count, arena_t *arena) {
+    uint32_t buckets[RECORD_TEXT_MAX];
+    uint32_t fields[RECORD_TEXT_MAX];
+
+    index->count = count;
+    index->text = arena_alloc(arena, (size_t)count * RECORD_TEXT_MAX + 1);
+    index->text_offset = arena_alloc(arena, ((size_t)count + 1) * sizeof(uint32_t));
+    index->bucket_start = arena_alloc(arena, (TRIGRAM_BUCKETS + 1) * sizeof(uint32_t));
+    uint32_t *cursor = arena_alloc(arena, TRIGRAM_BUCKETS * sizeof(uint32_t));
+    if (!index->text || !index->text_offset || !index->bucket_start || !cursor) return -1;
+
+    uint32_t len = 0;
+    for (int r = 0; r < count; r++) {
+        index->text_offset[r] = len;
+        len += append_field(index->text + len, entries[r].name, MAX_NAME_LEN - 1);
+        len += append_field(index->text + len, entries[r].platform, MAX_PLATFORM_LEN - 1);
+        len += append_field(index->text + len, entries[r].user, MAX_USER_LEN - 1);
+    }
+    index->text_offset[count] = len;
+
+    // cursor[b] = dernier champ compté + 1, pour ne compter qu'une fois par champ
+    uint32_t *start = index->bucket_start;
+    for (int r = 0; r < count; r++) {
+        int n = text_trigrams(index->text + index->text_offset[r],
+                              index->text_offset[r + 1] - index->text_offset[r], buckets, fields);
+        for (int i = 0; i < n; i++) {
+            uint32_t posting = (uint32_t)r * TRIGRAM_FIELDS + fields[i];
+            if (cursor[buckets[i]] != posting + 1) {
+                cursor[buckets[i]] = posting + 1;
+                start[buckets[i] + 1]++;
+            }
+        }
+    }
+    for (int b = 0; b < TRIGRAM_BUCKETS; b++) {
+        start[b + 1] += start[b];
+        cursor[b] = start[b];
+    }
+
+    index->postings = arena_alloc(arena, (size_t)start[TRIGRAM_BUCKETS] * sizeof(uint32_t));
+    if (index->postings == NULL) return -1;
+
+    for (int r = 0; r < count; r++) {
+        int n = text_trigrams(index->text + index->text_offset[r],
+                              index->text_offset[r + 1] - index->text_offset[r], buckets, fields);
+        for (int i = 0; i < n; i++) {
+            uint32_t b = buckets[i];
+            uint32_t posting = (uint32_t)r * TRIGRAM_FIELDS + fields[i];
+            if (cursor[b] == start[b] || index->postings[cursor[b] - 1] != posting) {
+                index->postings[cursor[b]++] = posting;
+            }
+        }
+    }
+    return 0;
+}
+
+// Entrée qui contient la position `pos` du texte (recherche dichotomique)
+static int record_at(const TrigramIndex *index, uint32_t pos) {
+    int lo = 0, hi = index->count - 1;
+    while (lo < hi) {
+        int mid = lo + (hi - lo + 1) / 2;
+        if (index->text_offset[mid] <= pos) lo = mid;
+        else hi = mid - 1;
+    }
+    return lo;
+}
+
+// Score d'une occurrence exacte de la requête (longueur qlen) en `match`
+static int exact_score(const TrigramIndex *index, int record, const char *match, size_t qlen) {
+    const char *rec = index->text + index->text_offset[record];
+    const char *name_end = memchr(rec, '\n', index->text_offset[record + 1] - index->text_offset[record]);
+    int score = SCORE_EXACT;
+
+    if (match < name_end) score += SCORE_IN_NAME;
+    if (match == rec || match[-1] == '\n') {
+        score += SCORE_PREFIX;
+        if (match[qlen] == '\n') score += SCORE_WHOLE;
+    }
+    return score;
+}
+
+// Insère un résultat en gardant les max_hits meilleurs (ordre des entrées à égalité)
+static void hit_insert(SearchHit *hits, int *n, int max_hits, int record, int score) {
+    if (*n == max_hits && hits[*n - 1].score >= score) return;
+
+    int i = (*n < max_hits) ? (*n)++ : *n - 1;
+    while (i > 0 && hits[i - 1].score < score) {
+        hits[i] = hits[i - 1];
+        i--;
+    }
+    hits[i].record = record;
+    hits[i].score = score;
+}
+
+/**
+ * Nombre de trigrammes de la requête (q + qpos[i]) présents dans le meilleur
+ * champ de l'entrée. Les cases de l'index sont hachées: deux trigrammes
+ * peuvent en partager une, ce recomptage écarte ces faux votes.
+ */
+static int best_field_trigrams(const TrigramIndex *index, int record, const char *q, const int *qpos, int distinct) {
+    const char *field = index->text + index->text_offset[record];
+    const char *end = index->text + index->text_offset[record + 1];
+    int best = 0;
+
+    while (field < end) {
+        const char *field_end = memchr(field, '\n', (size_t)(end - field));
+        int found = 0;
+        for (int i = 0; i < distinct; i++) {
+            if (memmem(field, (size_t)(field_end - field), q + qpos[i], 3) != NULL) found++;
+        }
+        if (found > best) best = found;
+        field = field_end + 1;
+    }
+    return best;
+}
+
+/**
+ * Cherche `query` (sans tenir compte de la casse) dans name, platform et user.
+ * Remplit `hits` avec les max_hits meilleurs résultats, du meilleur au moins bon.
+ * Retour: nombre total d'entrées correspondantes, -1 si la mémoire manque.
+ */
+int trigram_search(const TrigramIndex *index, const char *query, SearchHit *hits, int max_hits, arena_t *arena) {
+    char q[RECORD_TEXT_MAX];
+    uint32_t buckets[RECORD_TEXT_MAX];
+    int qpos[RECORD_TEXT_MAX];
+    int shown = 0, total = 0;
+
+    size_t qlen = 0;
+    while (query[qlen] != '\0' && qlen < MAX_NAME_LEN - 1) {
+        q[qlen] = to_lower(query[qlen]);
+        qlen++;
+    }
+    if (qlen == 0 || index->count == 0) return 0;
+
+    int nq = text_trigrams(q, qlen, buckets, NULL);
+    if (nq == 0) {
+        // Trop courte pour des trigrammes: memmem sur tout le texte
+        const char *p = index->text;
+        const char *end = index->text + index->text_offset[index->count];
+        const char *match;
+        while ((match = memmem(p, (size_t)(end - p), q, qlen)) != NULL) {
+            int r = record_at(index, (uint32_t)(match - index->text));
+            hit_insert(hits, &shown, max_hits, r, exact_score(index, r, match, qlen));
+            total++;
+            p = index->text + index->text_offset[r + 1];
+        }
+        return total;
+    }
+
+    // Trigrammes distincts de la requête, puis votes par champ
+    int distinct = 0;
+    for (int i = 0; i < nq; i++) {
+        int seen = 0;
+        for (int j = 0; j < distinct && !seen; j++) seen = (buckets[j] == buckets[i]);
+        if (!seen) {
+            qpos[distinct] = i;   // la requête n'a qu'un champ: trigramme i en q + i
+            buckets[distinct++] = buckets[i];
+        }
+    }
+
+    uint8_t *votes = arena_alloc(arena, (size_t)index->count * TRIGRAM_FIELDS);
+    if (votes == NULL) return -1;
+
+    for (int i = 0; i < distinct; i++) {
+        for (uint32_t k = index->bucket_start[buckets[i]]; k < index->bucket_start[buckets[i] + 1]; k++) {
+            votes[index->postings[k]]++;
+        }
+    }
+
+    // Une entrée vaut son meilleur champ: des trigrammes épars dans des champs
+    // différents ne forment pas une faute de frappe
+    for (int r = 0; r < index->count; r++) {
+        uint8_t *field_votes = votes + (size_t)r * TRIGRAM_FIELDS;
+        for (int f = 1; f < TRIGRAM_FIELDS; f++) {
+            if (field_votes[f] > field_votes[0]) field_votes[0] = field_votes[f];
+        }
+    }
+
+    /*
+     * Au plus une faute: SEARCH_TYPO_TRIGRAMS trigrammes détruits. Une requête
+     * courte doit les retrouver tous sauf un, et jamais moins de
+     * SEARCH_TYPO_TRIGRAMS dès qu'elle en a plus: sinon deux trigrammes
+     * communs à toutes les entrées ("ent", "ntr" de "entry...") suffiraient.
+     */
+    int min_votes = (distinct - 1 < SEARCH_TYPO_TRIGRAMS) ? distinct - 1 : SEARCH_TYPO_TRIGRAMS;
+    if (min_votes < distinct - SEARCH_TYPO_TRIGRAMS) min_votes = distinct - SEARCH_TYPO_TRIGRAMS;
+    if (min_votes < 1) min_votes = 1;
+
+    // Sous-chaînes exactes d'abord (elles ont forcément tous les trigrammes)
+    for (int r = 0; r < index->count; r++) {
+        if (votes[(size_t)r * TRIGRAM_FIELDS] < distinct) continue;
+
+        const char *rec = index->text + index->text_offset[r];
+        const char *match = memmem(rec, index->text_offset[r + 1] - index->text_offset[r], q, qlen);
+        if (match == NULL) continue;
+        hit_insert(hits, &shown, max_hits, r, exact_score(index, r, match, qlen));
+        total++;
+    }
+    if (total > 0) return total;
+
+    // Aucune: correspondances approchées
+    for (int r = 0; r < index->count; r++) {
+        if (votes[(size_t)r * TRIGRAM_FIELDS] < min_votes) continue;
+        int best = best_field_trigrams(index, r, q, qpos, distinct);
+        if (best < min_votes) continue;
+        hit_insert(hits, &shown, max_hits, r, best * 100 / distinct);
+        total++;
+    }
+    return total;
+}